@@ -1,4 +1,6 @@
 #include "tasks.hpp"
+#include "arena.hpp"
+#include "compressed.hpp"
 #include <omp.h>
 #include <chrono>
 using namespace std::chrono;
@@ -71,9 +73,13 @@ void dijkstra_parallel(std::vector<std::vector<tii>> &graph,
   int n = graph.size() - 1;
 
   std::vector<bool> visited(n + 1, false);
+  // 'break' isn't allowed in an OpenMP loop: once no reachable vertex is left
+  // (the target is unreachable or there's none), 'done' ends the remaining
+  // iterations before their scan of the vertices.
+  bool done = false;
 #pragma omp parallel for
   for (int i = 1; i <= n; ++i) {
-    if (visited[target])
+    if (done || visited[target])
       continue;
 
     int u = -1, dist = INT_MAX;
@@ -81,6 +87,10 @@ void dijkstra_parallel(std::vector<std::vector<tii>> &graph,
       if (!visited[v] && d[v] < dist)
         u = v, dist = d[v];
     }
+    if (u < 0) {
+      done = true;
+      continue;
+    }
     visited[u] = 1;
     for (auto const &[w, _, v] : graph[u])
       relax(u, v, w, d, pred);
@@ -126,6 +136,59 @@ void bellman_ford_timed(std::vector<std::vector<tii>> &graph, std::vector<int> &
   computation_time = duration_cast<nanoseconds>(stop - start).count();
 }
 
+/* Split the graph in the two DAG of Yen's algorithm (see 'bellman_ford_yen'
+ * below): edges (u, v) such that permutation[u] < permutation[v] (in 'ef') or
+ * not (in 'eb').
+ */
+template <class Adjacency>
+static void yen_split(std::vector<std::vector<tii>> &graph,
+                      std::vector<int> &permutation, Adjacency &ef,
+                      Adjacency &eb) {
+  int n = graph.size() - 1;
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, _, v] : graph[u])
+      permutation[u] < permutation[v] ? ef[u].push_back({w, v})
+                                      : eb[u].push_back({w, v});
+  }
+}
+
+/* Main loop of Yen's algorithm on the split graph ('rev_permutation' has n + 1
+ * entries).
+ */
+template <class Adjacency>
+static void yen_search(Adjacency &ef, Adjacency &eb, const int *rev_permutation,
+                       int n, std::vector<int> &d, std::vector<int> &pred,
+                       int source) {
+  arena_scope scope;
+  bool relaxation;
+  arena_vector<bool> to_relax(n + 1), queued(n + 1);
+  to_relax[source] = 1;
+  do {
+    relaxation = false;
+    for (int i = 0; i <= n; ++i) {
+      int u = rev_permutation[i];
+      if (to_relax[u] || queued[u]) {
+        for (auto const &[w, v] : ef[u]) {
+          if (relax(u, v, w, d, pred))
+            queued[v] = relaxation = true;
+        }
+      }
+    }
+
+    for (int i = n; i >= 0; --i) {
+      int u = rev_permutation[i];
+      if (to_relax[u] || queued[u]) {
+        for (auto const &[w, v] : eb[u]) {
+          if (relax(u, v, w, d, pred))
+            queued[v] = relaxation = true;
+        }
+      }
+    }
+    swap(to_relax, queued);
+    std::fill(queued.begin(), queued.end(), 0);
+  } while (relaxation);
+}
+
 /* Bellman-Ford algorithm using Jin Y. Yen and M. J. Bannister & D. Eppstein
  * optimizations, see:
  *   - "An algorithm for finding shortest routes from all source nodes to a
@@ -148,6 +211,7 @@ void bellman_ford_timed(std::vector<std::vector<tii>> &graph, std::vector<int> &
  */
 void bellman_ford_yen(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
                       std::vector<int> &pred, int source, int target) {
+  arena_scope scope;
   d[source] = 0;
   int n = graph.size() - 1;
 
@@ -156,44 +220,17 @@ void bellman_ford_yen(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
 
   // Sub-graphs (DAG) of G formed by edges (u, v) such that permutation[u] <
   // permutation[v] (resp. p...[u] > p...[v]).
-  std::vector<std::vector<pii>> ef(n + 1), eb(n + 1);
-  for (int u = 1; u <= n; ++u) {
-    for (auto const &[w, _, v] : graph[u])
-      permutation[u] < permutation[v] ? ef[u].push_back({w, v})
-                                      : eb[u].push_back({w, v});
-  }
-
-  bool relaxation;
-  std::vector<bool> to_relax(n + 1), queued(n + 1);
-  to_relax[source] = 1;
-  do {
-    relaxation = false;
-    for (auto const &u : rev_permutation) {
-      if (to_relax[u] || queued[u]) {
-        for (auto const &[w, v] : ef[u]) {
-          if (relax(u, v, w, d, pred))
-            queued[v] = relaxation = true;
-        }
-      }
-    }
+  arena_vector<arena_vector<pii>> ef(n + 1), eb(n + 1);
+  yen_split(graph, permutation, ef, eb);
 
-    for (auto u = rev_permutation.rbegin(); u != rev_permutation.rend(); ++u) {
-      if (to_relax[*u] || queued[*u]) {
-        for (auto const &[w, v] : eb[*u]) {
-          if (relax(*u, v, w, d, pred))
-            queued[v] = relaxation = true;
-        }
-      }
-    }
-    swap(to_relax, queued);
-    std::fill(queued.begin(), queued.end(), 0);
-  } while (relaxation);
+  yen_search(ef, eb, rev_permutation.data(), n, d, pred, source);
 }
 
 void bellman_ford_yen_timed(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
                       std::vector<int> &pred, int source, int target,
                       long long int &preprocess_time, long long int &computation_time) {
   auto start = high_resolution_clock::now();
+  arena_scope scope;
   d[source] = 0;
   int n = graph.size() - 1;
 
@@ -202,57 +239,104 @@ void bellman_ford_yen_timed(std::vector<std::vector<tii>> &graph, std::vector<in
 
   // Sub-graphs (DAG) of G formed by edges (u, v) such that permutation[u] <
   // permutation[v] (resp. p...[u] > p...[v]).
-  std::vector<std::vector<pii>> ef(n + 1), eb(n + 1);
-  
-  for (int u = 1; u <= n; ++u) {
-    for (auto const &[w, _, v] : graph[u])
-      permutation[u] < permutation[v] ? ef[u].push_back({w, v})
-                                      : eb[u].push_back({w, v});
-  }
-
-  bool relaxation;
-  std::vector<bool> to_relax(n + 1), queued(n + 1);
-  to_relax[source] = 1;
+  arena_vector<arena_vector<pii>> ef(n + 1), eb(n + 1);
+  yen_split(graph, permutation, ef, eb);
 
   auto stop = high_resolution_clock::now();
   preprocess_time = duration_cast<nanoseconds>(stop - start).count();
 
   start = high_resolution_clock::now();
-  do {
-    relaxation = false;
-    for (auto const &u : rev_permutation) {
-      if (to_relax[u] || queued[u]) {
-        for (auto const &[w, v] : ef[u]) {
-          if (relax(u, v, w, d, pred))
-            queued[v] = relaxation = true;
-        }
-      }
-    }
+  yen_search(ef, eb, rev_permutation.data(), n, d, pred, source);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
 
-    for (auto u = rev_permutation.rbegin(); u != rev_permutation.rend(); ++u) {
-      if (to_relax[*u] || queued[*u]) {
-        for (auto const &[w, v] : eb[*u]) {
-          if (relax(*u, v, w, d, pred))
-            queued[v] = relaxation = true;
-        }
-      }
+/* Append to 'ints' the CSR offsets (n + 2 entries, see 'csr_adjacency') of
+ * the edges (u, v) of the graph such that 'side(u, w, v)' is 'first' and store
+ * these edges in 'pairs'.
+ */
+template <class Side>
+static void csr_side(std::vector<std::vector<tii>> &graph, Side side,
+                     bool first, std::vector<int> &ints,
+                     std::vector<pii> &pairs) {
+  int n = graph.size() - 1;
+  for (int u = 0; u <= n; ++u) {
+    ints.push_back(pairs.size());
+    for (auto const &[w, _, v] : graph[u]) {
+      if (side(u, w, v) == first)
+        pairs.push_back({w, v});
     }
-    swap(to_relax, queued);
-    std::fill(queued.begin(), queued.end(), 0);
-  } while (relaxation);
+  }
+  ints.push_back(pairs.size());
+}
 
-  stop = high_resolution_clock::now();
+/* Point the views of a plan to its arrays: for Yen's plan, 'ints' holds the
+ * reverse permutation (n + 1 entries) then the offsets of 'ef' and 'eb', for
+ * the Δ-stepping one the offsets of 'el' and 'eh'. The edges of both sides are
+ * in 'pairs'. The arrays are the ones of the plan or the ones mapped from an
+ * index file (see 'index.cpp').
+ */
+void attach_yen_plan(yen_plan &plan, int n, const int *ints,
+                     const pii *pairs) {
+  plan.n = n;
+  plan.rev_permutation = ints;
+  plan.ef = {ints + (n + 1), pairs};
+  plan.eb = {ints + (n + 1) + (n + 2), pairs};
+}
+
+void attach_delta_plan(delta_plan &plan, int n, int delta, const int *ints,
+                       const pii *pairs) {
+  plan.delta = delta;
+  plan.el = {ints, pairs};
+  plan.eh = {ints + (n + 2), pairs};
+}
+
+/* Build the random permutation and the split graph of the above algorithm once
+ * for all the queries on the graph. The plan is only read by the queries, it
+ * can be shared between threads.
+ */
+void prepare_yen(std::vector<std::vector<tii>> &graph, yen_plan &plan) {
+  int n = graph.size() - 1;
+  std::vector<int> permutation(n + 1), rev_permutation(n + 1);
+  random_permutation(n, permutation, rev_permutation);
+  auto forward = [&permutation](int u, int w, int v) {
+    return permutation[u] < permutation[v];
+  };
+  plan.ints = rev_permutation;
+  plan.pairs.clear();
+  csr_side(graph, forward, true, plan.ints, plan.pairs);
+  csr_side(graph, forward, false, plan.ints, plan.pairs);
+  attach_yen_plan(plan, n, plan.ints.data(), plan.pairs.data());
+}
+
+void bellman_ford_yen_prepared(yen_plan &plan, std::vector<int> &d,
+                               std::vector<int> &pred, int source,
+                               int target) {
+  d[source] = 0;
+  yen_search(plan.ef, plan.eb, plan.rev_permutation, plan.n, d, pred, source);
+}
+
+void bellman_ford_yen_prepared_timed(yen_plan &plan, std::vector<int> &d,
+                                     std::vector<int> &pred, int source,
+                                     int target, long long int &preprocess_time,
+                                     long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  bellman_ford_yen_prepared(plan, d, pred, source, target);
+  auto stop = high_resolution_clock::now();
   computation_time = duration_cast<nanoseconds>(stop - start).count();
 }
+
 /* An implementation of the Δ-stepping algorithm by U. Meyer and P. Sanders,
  * see:
  *    - "Δ-stepping: a parallelizable shortest path algorithm". Journal of
  * Algorithms. 1998 European Symposium on Algorithms.
  */
-void relax_requests(int u, int delta, std::vector<std::vector<pii>> &edges,
-                    std::vector<int> &d, std::vector<int> &pred,
-                    std::map<int, std::unordered_set<int>> &B) {
-  std::unordered_set<int> *Bi;
+template <class Adjacency>
+static void relax_requests(int u, int delta, Adjacency &edges,
+                           std::vector<int> &d, std::vector<int> &pred,
+                           arena_map<int, arena_unordered_set<int>> &B) {
+  arena_unordered_set<int> *Bi;
   int idx, old_idx;
   for (auto const &[w, v] : edges[u]) {
     if (d[v] != INT_MAX) {
@@ -272,27 +356,33 @@ void relax_requests(int u, int delta, std::vector<std::vector<pii>> &edges,
   }
 }
 
-void delta_stepping(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
-                    std::vector<int> &pred, int source, int target, int delta) {
-  d[source] = 0;
+/* Sub-graphs of G formed by 'light' (resp. 'heavy') edges (u, v) i.e. w(u, v)
+ * <= Δ (resp. w(u, v) > Δ).
+ */
+template <class Adjacency>
+static void delta_split(std::vector<std::vector<tii>> &graph, int delta,
+                        Adjacency &el, Adjacency &eh) {
   int n = graph.size() - 1;
-
-  // Sub-graphs of G formed by 'light' (resp. 'heavy') edges (u, v) i.e. w(u,
-  // v)
-  // <= Δ (resp. w(u, v) > Δ).
-  std::vector<std::vector<pii>> el(n + 1), eh(n + 1);
   for (int u = 1; u <= n; ++u) {
     for (auto const &[w, _, v] : graph[u])
       w <= delta ? el[u].push_back({w, v}) : eh[u].push_back({w, v});
   }
+}
 
-  std::map<int, std::unordered_set<int>> B;
+/* Main loop of the Δ-stepping on the split graph.
+ */
+template <class Adjacency>
+static void delta_search(Adjacency &el, Adjacency &eh, int delta,
+                         std::vector<int> &d, std::vector<int> &pred,
+                         int source) {
+  arena_scope scope;
+  arena_map<int, arena_unordered_set<int>> B;
   B[0].insert(source);
   while (!B.empty()) {
     int i = B.begin()->first;
     auto &Bi = B.begin()->second;
 
-    std::unordered_set<int> R;
+    arena_unordered_set<int> R;
     do {
       auto bi = Bi;
       R.insert(Bi.begin(), Bi.end());
@@ -308,47 +398,290 @@ void delta_stepping(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
   }
 }
 
+void delta_stepping(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
+                    std::vector<int> &pred, int source, int target, int delta) {
+  arena_scope scope;
+  d[source] = 0;
+  int n = graph.size() - 1;
+
+  arena_vector<arena_vector<pii>> el(n + 1), eh(n + 1);
+  delta_split(graph, delta, el, eh);
+
+  delta_search(el, eh, delta, d, pred, source);
+}
+
 void delta_stepping_timed(std::vector<std::vector<tii>> &graph, std::vector<int> &d,
                     std::vector<int> &pred, int source, int target, int delta,
                     long long int &preprocess_time, long long int &computation_time) {
   auto start = high_resolution_clock::now();
+  arena_scope scope;
   d[source] = 0;
   int n = graph.size() - 1;
 
-  // Sub-graphs of G formed by 'light' (resp. 'heavy') edges (u, v) i.e. w(u,
-  // v)
-  // <= Δ (resp. w(u, v) > Δ).
-  std::vector<std::vector<pii>> el(n + 1), eh(n + 1);
-  for (int u = 1; u <= n; ++u) {
-    for (auto const &[w, _, v] : graph[u])
-      w <= delta ? el[u].push_back({w, v}) : eh[u].push_back({w, v});
+  arena_vector<arena_vector<pii>> el(n + 1), eh(n + 1);
+  delta_split(graph, delta, el, eh);
+
+  auto stop = high_resolution_clock::now();
+  preprocess_time = duration_cast<nanoseconds>(stop - start).count();
+
+  start = high_resolution_clock::now();
+  delta_search(el, eh, delta, d, pred, source);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Build the light/heavy split of the Δ-stepping once for all the queries on
+ * the graph with this Δ (shareable between threads as 'prepare_yen').
+ */
+void prepare_delta_stepping(std::vector<std::vector<tii>> &graph, int delta,
+                            delta_plan &plan) {
+  int n = graph.size() - 1;
+  auto light = [delta](int u, int w, int v) { return w <= delta; };
+  plan.ints.clear();
+  plan.pairs.clear();
+  csr_side(graph, light, true, plan.ints, plan.pairs);
+  csr_side(graph, light, false, plan.ints, plan.pairs);
+  attach_delta_plan(plan, n, delta, plan.ints.data(), plan.pairs.data());
+}
+
+void delta_stepping_prepared(delta_plan &plan, std::vector<int> &d,
+                             std::vector<int> &pred, int source, int target) {
+  d[source] = 0;
+  delta_search(plan.el, plan.eh, plan.delta, d, pred, source);
+}
+
+void delta_stepping_prepared_timed(delta_plan &plan, std::vector<int> &d,
+                                   std::vector<int> &pred, int source,
+                                   int target, long long int &preprocess_time,
+                                   long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  delta_stepping_prepared(plan, d, pred, source, target);
+  auto stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Label-correcting loop of the subtree disassembly algorithm (see below): 'd',
+ * 'pred', the preorder thread ('next', 'prev'), 'depth', 'in_tree' and the
+ * FIFO queue are assumed to be initialized (with the tree rooted at 'root').
+ */
+static bool subtree_disassembly(std::vector<std::vector<tii>> &graph,
+                                std::vector<int> &d, std::vector<int> &pred,
+                                std::vector<int> &next, std::vector<int> &prev,
+                                std::vector<int> &depth,
+                                std::vector<bool> &in_tree,
+                                std::vector<bool> &in_queue,
+                                std::queue<int> &queue,
+                                std::vector<int> &cycle) {
+  int u, x, p;
+  while (!queue.empty()) {
+    u = queue.front();
+    queue.pop();
+    in_queue[u] = false;
+    if (!in_tree[u])
+      continue;
+
+    for (auto const &[w, _, v] : graph[u]) {
+      p = d[u] + w;
+      if (p >= d[v])
+        continue;
+
+      if (in_tree[v]) {
+        // Remove the subtree rooted at v from the tree, u being in it means
+        // that the edge (u, v) closes a negative cycle.
+        for (x = v; x == v || depth[x] > depth[v]; x = next[x]) {
+          if (x == u) {
+            for (x = u; x != v; x = pred[x])
+              cycle.push_back(x);
+            cycle.push_back(v);
+            std::reverse(cycle.begin(), cycle.end());
+            cycle.push_back(v);
+            return false;
+          }
+          in_tree[x] = false;
+        }
+        next[prev[v]] = x;
+        prev[x] = prev[v];
+      }
+
+      // Attach v as the first child of u.
+      d[v] = p;
+      pred[v] = u;
+      in_tree[v] = true;
+      depth[v] = depth[u] + 1;
+      next[v] = next[u];
+      prev[next[u]] = v;
+      next[u] = v;
+      prev[v] = u;
+      if (!in_queue[v]) {
+        in_queue[v] = true;
+        queue.push(v);
+      }
+    }
   }
+  return true;
+}
 
-  std::map<int, std::unordered_set<int>> B;
-  B[0].insert(source);
+/* A label-correcting algorithm with R. E. Tarjan's subtree disassembly, see:
+ *   - "Shortest paths", AT&T Bell Laboratories technical report (1981).
+ *   - B. V. Cherkassky and A. V. Goldberg, "Negative-cycle detection
+ * algorithms", Mathematical Programming 85 (1999), pp. 277-311.
+ *
+ * It's the FIFO Bellman-Ford algorithm in which the shortest path tree is kept
+ * as a preorder thread: when d[v] decreases, the whole subtree of v is removed
+ * from the tree (its labels are obsolete, so its vertices aren't scanned until
+ * they are improved again). A negative cycle is detected as soon as it forms
+ * i.e. when u belongs to the subtree of v for a relaxed edge (u, v). Then
+ * 'false' is returned and the cycle is stored in 'cycle' (first vertex
+ * repeated at the end), 'true' otherwise.
+ */
+bool bellman_ford_tarjan(std::vector<std::vector<tii>> &graph,
+                         std::vector<int> &d, std::vector<int> &pred,
+                         int source, int target, std::vector<int> &cycle) {
+  int n = graph.size() - 1;
+  std::vector<int> next(n + 1), prev(n + 1), depth(n + 1);
+  std::vector<bool> in_tree(n + 1), in_queue(n + 1);
+  std::queue<int> queue;
+
+  d[source] = 0;
+  next[source] = prev[source] = source;
+  in_tree[source] = in_queue[source] = true;
+  queue.push(source);
+  return subtree_disassembly(graph, d, pred, next, prev, depth, in_tree,
+                             in_queue, queue, cycle);
+}
+
+bool bellman_ford_tarjan_timed(std::vector<std::vector<tii>> &graph,
+                               std::vector<int> &d, std::vector<int> &pred,
+                               int source, int target, std::vector<int> &cycle,
+                               long long int &preprocess_time,
+                               long long int &computation_time) {
+  auto start = high_resolution_clock::now();
+  int n = graph.size() - 1;
+  std::vector<int> next(n + 1), prev(n + 1), depth(n + 1);
+  std::vector<bool> in_tree(n + 1), in_queue(n + 1);
+  std::queue<int> queue;
+
+  d[source] = 0;
+  next[source] = prev[source] = source;
+  in_tree[source] = in_queue[source] = true;
+  queue.push(source);
 
   auto stop = high_resolution_clock::now();
   preprocess_time = duration_cast<nanoseconds>(stop - start).count();
 
   start = high_resolution_clock::now();
-  while (!B.empty()) {
-    int i = B.begin()->first;
-    auto &Bi = B.begin()->second;
+  bool no_cycle = subtree_disassembly(graph, d, pred, next, prev, depth,
+                                      in_tree, in_queue, queue, cycle);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+  return no_cycle;
+}
 
-    std::unordered_set<int> R;
-    do {
-      auto bi = Bi;
-      R.insert(Bi.begin(), Bi.end());
-      Bi.clear();
+/* Compute the potentials h of D. B. Johnson's reweighting, see:
+ *   - "Efficient algorithms for shortest paths in sparse networks", Journal of
+ * the ACM, Vol. 24, No. 1 (1977), pp. 1-13.
+ *
+ * h(v) is the distance to v from a virtual vertex (the unused vertex 0) linked
+ * to every vertex with a null weight, computed with the subtree disassembly
+ * algorithm. Return 'false' (and the cycle) if the graph has a negative cycle.
+ */
+bool johnson_potentials(std::vector<std::vector<tii>> &graph,
+                        std::vector<int> &h, std::vector<int> &cycle) {
+  int n = graph.size() - 1;
+  std::vector<int> pred(n + 1), next(n + 1), prev(n + 1), depth(n + 1, 1);
+  std::vector<bool> in_tree(n + 1, true), in_queue(n + 1, true);
+  std::queue<int> queue;
+
+  h.assign(n + 1, 0);
+  depth[0] = 0;
+  in_queue[0] = false;
+  for (int v = 0; v <= n; ++v) {
+    next[v] = v < n ? v + 1 : 0;
+    prev[v] = v > 0 ? v - 1 : n;
+    if (v > 0)
+      queue.push(v);
+  }
+  return subtree_disassembly(graph, h, pred, next, prev, depth, in_tree,
+                             in_queue, queue, cycle);
+}
 
-      for (auto const &u : bi)
-        relax_requests(u, delta, el, d, pred, B);
-    } while (!Bi.empty());
+/* Build the reweighted graph w'(u, v) = w(u, v) + h(u) - h(v) >= 0 on which
+ * the non-negative engines (e.g. Dijkstra's algorithm) can be used.
+ */
+void johnson_reweight(std::vector<std::vector<tii>> &graph,
+                      std::vector<int> &h,
+                      std::vector<std::vector<tii>> &reweighted) {
+  int n = graph.size() - 1;
+  reweighted.assign(n + 1, {});
+  for (int u = 1; u <= n; ++u) {
+    reweighted[u].reserve(graph[u].size());
+    for (auto const &[w, z, v] : graph[u])
+      reweighted[u].push_back({w + h[u] - h[v], z, v});
+  }
+}
 
-    for (auto const &u : R)
-      relax_requests(u, delta, eh, d, pred, B);
-    B.erase(i);
+/* Dijkstra's algorithm on the reweighted graph, the distances are translated
+ * back to the original weights: d(s, v) = d'(s, v) - h(s) + h(v).
+ */
+void dijkstra_johnson(std::vector<std::vector<tii>> &reweighted,
+                      std::vector<int> &h, std::vector<int> &d,
+                      std::vector<int> &pred, int source, int target) {
+  dijkstra(reweighted, d, pred, source, target);
+  for (size_t v = 1; v < d.size(); ++v) {
+    if (d[v] < INT_MAX)
+      d[v] += h[v] - h[source];
   }
-  stop = high_resolution_clock::now();
+}
+
+void dijkstra_johnson_timed(std::vector<std::vector<tii>> &reweighted,
+                            std::vector<int> &h, std::vector<int> &d,
+                            std::vector<int> &pred, int source, int target,
+                            long long int &preprocess_time,
+                            long long int &computation_time) {
+  dijkstra_timed(reweighted, d, pred, source, target, preprocess_time,
+                 computation_time);
+  auto start = high_resolution_clock::now();
+  for (size_t v = 1; v < d.size(); ++v) {
+    if (d[v] < INT_MAX)
+      d[v] += h[v] - h[source];
+  }
+  auto stop = high_resolution_clock::now();
+  computation_time += duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Dijkstra's algorithm on the compressed adjacency (see 'compressed.hpp'), the
+ * edges being decoded on the fly.
+ */
+void dijkstra_compressed(compressed_graph &cg, std::vector<int> &d,
+                         std::vector<int> &pred, int source, int target) {
+  d[source] = 0;
+
+  std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq(
+      {}, {{0, source}});
+  int l, u;
+  while (!pq.empty()) {
+    std::tie(l, u) = pq.top();
+    if (u == target)
+      return;
+
+    pq.pop();
+    if (l <= d[u]) {
+      for_each_edge(cg, u, [&](int w, int, int v) {
+        if (relax(u, v, w, d, pred))
+          pq.push({d[v], v});
+      });
+    }
+  }
+}
+
+void dijkstra_compressed_timed(compressed_graph &cg, std::vector<int> &d,
+                               std::vector<int> &pred, int source, int target,
+                               long long int &preprocess_time,
+                               long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  dijkstra_compressed(cg, d, pred, source, target);
+  auto stop = high_resolution_clock::now();
   computation_time = duration_cast<nanoseconds>(stop - start).count();
 }
@@ -1,5 +1,8 @@
 #include "tasks.hpp"
+#include "compressed.hpp"
+#include "deadline.hpp"
 #include <chrono>
+#include <thread>
 using namespace std::chrono;
 
 void dijkstra_constrained(std::vector<std::vector<tii>> &graph,
@@ -63,6 +66,328 @@ void dijkstra_constrained_timed(std::vector<std::vector<tii>> &graph,
   computation_time = duration_cast<nanoseconds>(stop - start).count();
 }
 
+/* Anytime variant of the above algorithm: the search stops when the deadline
+ * expires (or the query is cancelled). The labels of the target found so far
+ * are feasible paths (the best one is read from 'pred' as usual) and the top
+ * of the queue is a lower bound on the optimal (delay, length) pair.
+ */
+void dijkstra_constrained_anytime(std::vector<std::vector<tii>> &graph,
+                                  std::vector<std::vector<int>> &d,
+                                  std::vector<std::vector<pii>> &pred,
+                                  int source, int target, int b,
+                                  query_deadline &deadline,
+                                  anytime_result &result) {
+  auto start = std::chrono::steady_clock::now();
+  result = {};
+  d[source][0] = 0;
+  std::priority_queue<tii, std::vector<tii>, std::greater<tii>> pq(
+      {}, {{0, 0, source}});
+
+  int u, dist, l, delay;
+  while (!pq.empty()) {
+    std::tie(l, dist, u) = pq.top();
+    result.delay_bound = l, result.length_bound = dist;
+    if (u == target) {
+      if (result.first_time < 0)
+        result.first_time = elapsed_since(start);
+      result.optimal = true;
+      result.optimal_time = elapsed_since(start);
+      return;
+    }
+    if (deadline.expired())
+      return;
+
+    pq.pop();
+    if (dist <= d[u][l]) {
+      for (auto const &[w, z, v] : graph[u]) {
+        delay = l + z;
+        if (delay <= b && relax_delay(u, v, w, delay, l, d, pred)) {
+          pq.push({delay, d[v][delay], v});
+          if (v == target && result.first_time < 0)
+            result.first_time = elapsed_since(start);
+        }
+      }
+    }
+  }
+  // The target can't be reached within the bound.
+  result.delay_bound = b + 1, result.length_bound = 0;
+  result.optimal = true;
+  result.optimal_time = elapsed_since(start);
+}
+
+/* The above algorithm on the compressed adjacency (see 'compressed.hpp'), the
+ * edges being decoded on the fly.
+ */
+void dijkstra_constrained_compressed(compressed_graph &cg,
+                                     std::vector<std::vector<int>> &d,
+                                     std::vector<std::vector<pii>> &pred,
+                                     int source, int target, int b) {
+  d[source][0] = 0;
+  std::priority_queue<tii, std::vector<tii>, std::greater<tii>> pq(
+      {}, {{0, 0, source}});
+
+  int u, dist, l, delay;
+  while (!pq.empty()) {
+    std::tie(l, dist, u) = pq.top();
+    if (u == target)
+      break;
+
+    pq.pop();
+    if (dist <= d[u][l]) {
+      for_each_edge(cg, u, [&](int w, int z, int v) {
+        delay = l + z;
+        if (delay <= b && relax_delay(u, v, w, delay, l, d, pred))
+          pq.push({delay, d[v][delay], v});
+      });
+    }
+  }
+}
+
+/* Anytime variant of the above algorithm, as 'dijkstra_constrained_anytime'.
+ */
+void dijkstra_constrained_compressed_anytime(compressed_graph &cg,
+                                             std::vector<std::vector<int>> &d,
+                                             std::vector<std::vector<pii>> &pred,
+                                             int source, int target, int b,
+                                             query_deadline &deadline,
+                                             anytime_result &result) {
+  auto start = std::chrono::steady_clock::now();
+  result = {};
+  d[source][0] = 0;
+  std::priority_queue<tii, std::vector<tii>, std::greater<tii>> pq(
+      {}, {{0, 0, source}});
+
+  int u, dist, l, delay;
+  while (!pq.empty()) {
+    std::tie(l, dist, u) = pq.top();
+    result.delay_bound = l, result.length_bound = dist;
+    if (u == target) {
+      if (result.first_time < 0)
+        result.first_time = elapsed_since(start);
+      result.optimal = true;
+      result.optimal_time = elapsed_since(start);
+      return;
+    }
+    if (deadline.expired())
+      return;
+
+    pq.pop();
+    if (dist <= d[u][l]) {
+      for_each_edge(cg, u, [&](int w, int z, int v) {
+        delay = l + z;
+        if (delay <= b && relax_delay(u, v, w, delay, l, d, pred)) {
+          pq.push({delay, d[v][delay], v});
+          if (v == target && result.first_time < 0)
+            result.first_time = elapsed_since(start);
+        }
+      });
+    }
+  }
+  result.delay_bound = b + 1, result.length_bound = 0;
+  result.optimal = true;
+  result.optimal_time = elapsed_since(start);
+}
+
+void dijkstra_constrained_compressed_timed(compressed_graph &cg,
+                                           std::vector<std::vector<int>> &d,
+                                           std::vector<std::vector<pii>> &pred,
+                                           int source, int target, int b,
+                                           long long int &preprocess_time,
+                                           long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  dijkstra_constrained_compressed(cg, d, pred, source, target, b);
+  auto stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Radix heap of pairs (distance, vertex) by R. K. Ahuja, K. Mehlhorn, J. B.
+ * Orlin and R. E. Tarjan, see:
+ *    - "Faster algorithms for the shortest path problem". Journal of the ACM.
+ * 1990.
+ *
+ * The keys must be monotone (never smaller than the last popped one, 'last'):
+ * bucket 0 holds the keys equal to 'last' and bucket i > 0 the ones whose
+ * highest bit differing from 'last' is the bit i - 1. A key is thus moved at
+ * most 32 times, when the first non-empty bucket is redistributed around its
+ * minimum. A smaller key (a negative weight) goes to bucket 0 without breaking
+ * the structure, but the order is then no longer guaranteed.
+ *
+ * A vertex has at most one entry: its position (bucket, slot) is kept in
+ * 'where' ((-1, -1) if it has none, allocated on the first push) so that a
+ * smaller key replaces its entry instead of adding a second one.
+ */
+struct radix_heap {
+  int last = 0;
+  size_t size = 0;
+  std::vector<pii> buckets[33];
+  std::vector<pii> where;
+};
+
+static int radix_bucket(radix_heap &heap, int key) {
+  if (key <= heap.last)
+    return 0;
+  return 32 - __builtin_clz((unsigned int)key ^ (unsigned int)heap.last);
+}
+
+static void radix_place(radix_heap &heap, int i, pii entry) {
+  heap.where[entry.second] = {i, (int)heap.buckets[i].size()};
+  heap.buckets[i].push_back(entry);
+}
+
+/* Insert the vertex v (at most n) with the key 'key', or decrease its key if
+ * it's already in the heap: its entry is replaced by the last one of its
+ * bucket and it's inserted again in the bucket of its new key.
+ */
+static void radix_push(radix_heap &heap, int key, int v, int n) {
+  if (heap.where.empty())
+    heap.where.assign(n + 1, {-1, -1});
+  auto [i, slot] = heap.where[v];
+  if (i >= 0) {
+    auto &bucket = heap.buckets[i];
+    bucket[slot] = bucket.back();
+    heap.where[bucket[slot].second].second = slot;
+    bucket.pop_back();
+    --heap.size;
+  }
+  radix_place(heap, radix_bucket(heap, key), {key, v});
+  ++heap.size;
+}
+
+/* Pop a pair of minimum key (the heap must not be empty).
+ */
+static pii radix_pop(radix_heap &heap) {
+  if (heap.buckets[0].empty()) {
+    int i = 1;
+    while (heap.buckets[i].empty())
+      ++i;
+    auto &bucket = heap.buckets[i];
+    heap.last = std::min_element(bucket.begin(), bucket.end())->first;
+    std::vector<pii> entries;
+    entries.swap(bucket);
+    for (auto const &e : entries)
+      radix_place(heap, radix_bucket(heap, e.first), e);
+  }
+  pii top = heap.buckets[0].back();
+  heap.buckets[0].pop_back();
+  heap.where[top.second] = {-1, -1};
+  --heap.size;
+  return top;
+}
+
+/* The same search as 'dijkstra_constrained' but the priority queue on (delay,
+ * dist, vertex) is replaced by a two-level bucket queue: an array indexed by
+ * the delay (which is bounded by b) of radix heaps keyed by the distance. The
+ * delay layers are scanned in increasing order and, within a layer, the keys
+ * are monotone with non-negative weights (a label pushed in the current layer
+ * comes from a label of this layer, the other ones go to later layers), so a
+ * push (or decrease-key) is O(1) and a pop O(1) amortized per bit of the key.
+ * Each (vertex, delay) label has at most one entry in the heap of its layer,
+ * moved when its distance decreases. The lengths are the ones of
+ * 'dijkstra_constrained' (the ties may be broken differently).
+ */
+static void bucket_search(std::vector<std::vector<tii>> &graph,
+                          std::vector<std::vector<int>> &d,
+                          std::vector<std::vector<pii>> &pred, int target,
+                          int b, std::vector<radix_heap> &buckets) {
+  int n = graph.size() - 1, u, dist, delay;
+  for (int l = 0; l <= b; ++l) {
+    auto &heap = buckets[l];
+    while (heap.size) {
+      std::tie(dist, u) = radix_pop(heap);
+      if (u == target)
+        return;
+
+      for (auto const &[w, z, v] : graph[u]) {
+        delay = l + z;
+        if (delay <= b && relax_delay(u, v, w, delay, l, d, pred))
+          radix_push(buckets[delay], d[v][delay], v, n);
+      }
+    }
+    heap = radix_heap();
+  }
+}
+
+void dijkstra_constrained_bucket(std::vector<std::vector<tii>> &graph,
+                                 std::vector<std::vector<int>> &d,
+                                 std::vector<std::vector<pii>> &pred,
+                                 int source, int target, int b) {
+  d[source][0] = 0;
+  std::vector<radix_heap> buckets(b + 1);
+  radix_push(buckets[0], 0, source, graph.size() - 1);
+
+  bucket_search(graph, d, pred, target, b, buckets);
+}
+
+void dijkstra_constrained_bucket_timed(std::vector<std::vector<tii>> &graph,
+                                       std::vector<std::vector<int>> &d,
+                                       std::vector<std::vector<pii>> &pred,
+                                       int source, int target, int b,
+                                       long long int &preprocess_time,
+                                       long long int &computation_time) {
+  auto start = high_resolution_clock::now();
+  d[source][0] = 0;
+  std::vector<radix_heap> buckets(b + 1);
+  radix_push(buckets[0], 0, source, graph.size() - 1);
+
+  auto stop = high_resolution_clock::now();
+  preprocess_time = duration_cast<nanoseconds>(stop - start).count();
+
+  start = high_resolution_clock::now();
+  bucket_search(graph, d, pred, target, b, buckets);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Anytime variant of the above algorithm: the search stops when the deadline
+ * expires (or the query is cancelled), the last popped label (its delay layer
+ * and distance) is then a lower bound on the optimal (delay, length) pair and
+ * the labels of the target found so far are feasible paths.
+ */
+void dijkstra_constrained_bucket_anytime(std::vector<std::vector<tii>> &graph,
+                                         std::vector<std::vector<int>> &d,
+                                         std::vector<std::vector<pii>> &pred,
+                                         int source, int target, int b,
+                                         query_deadline &deadline,
+                                         anytime_result &result) {
+  auto start = std::chrono::steady_clock::now();
+  result = {};
+  d[source][0] = 0;
+  int n = graph.size() - 1, u, dist, delay;
+  std::vector<radix_heap> buckets(b + 1);
+  radix_push(buckets[0], 0, source, n);
+
+  for (int l = 0; l <= b; ++l) {
+    auto &heap = buckets[l];
+    while (heap.size) {
+      std::tie(dist, u) = radix_pop(heap);
+      result.delay_bound = l, result.length_bound = dist;
+      if (u == target) {
+        if (result.first_time < 0)
+          result.first_time = elapsed_since(start);
+        result.optimal = true;
+        result.optimal_time = elapsed_since(start);
+        return;
+      }
+      if (deadline.expired())
+        return;
+
+      for (auto const &[w, z, v] : graph[u]) {
+        delay = l + z;
+        if (delay <= b && relax_delay(u, v, w, delay, l, d, pred)) {
+          radix_push(buckets[delay], d[v][delay], v, n);
+          if (v == target && result.first_time < 0)
+            result.first_time = elapsed_since(start);
+        }
+      }
+    }
+    heap = radix_heap();
+  }
+  result.delay_bound = b + 1, result.length_bound = 0;
+  result.optimal = true;
+  result.optimal_time = elapsed_since(start);
+}
+
 /* A variant of the Bellman-Ford algorithm for the constrains shortest path
  * problem using a dynamic programming approach. This algorithm runs in time O(n
  * m b) where n = |V|, m = |E| and b is the delay bound.
@@ -92,6 +417,54 @@ void bellman_ford_constrained(std::vector<std::vector<tii>> &graph,
 }
 
 
+/* Anytime variant of the above algorithm. The layers are computed by
+ * increasing delay, so the search stops as soon as a layer reaches the target
+ * (the path of minimal delay is then known) or when the deadline expires: the
+ * labels of the target in the current layer are then feasible paths and their
+ * delay is a lower bound on the optimal one (the earlier layers are complete).
+ */
+void bellman_ford_constrained_anytime(std::vector<std::vector<tii>> &graph,
+                                      std::vector<std::vector<int>> &d,
+                                      std::vector<std::vector<pii>> &pred,
+                                      int source, int target, int b,
+                                      query_deadline &deadline,
+                                      anytime_result &result) {
+  auto start = std::chrono::steady_clock::now();
+  result = {};
+  std::fill(d[source].begin(), d[source].end(), 0);
+  std::fill(pred[source].begin(), pred[source].end(), pii{source, 0});
+  int n = graph.size() - 1, l;
+
+  for (int delay = 0; delay <= b; ++delay) {
+    result.delay_bound = delay, result.length_bound = 0;
+    for (int _ = 1; _ < n; ++_) {
+      for (int u = 1; u <= n; ++u) {
+        if (deadline.expired())
+          return;
+        for (auto const &[w, z, v] : graph[u]) {
+          if (z <= delay) {
+            l = delay - z;
+            if (d[u][l] < INT_MAX && relax_delay(u, v, w, delay, l, d, pred) &&
+                v == target && result.first_time < 0)
+              result.first_time = elapsed_since(start);
+          }
+        }
+      }
+    }
+    if (d[target][delay] < INT_MAX) {
+      if (result.first_time < 0)
+        result.first_time = elapsed_since(start);
+      result.length_bound = d[target][delay];
+      result.optimal = true;
+      result.optimal_time = elapsed_since(start);
+      return;
+    }
+  }
+  result.delay_bound = b + 1;
+  result.optimal = true;
+  result.optimal_time = elapsed_since(start);
+}
+
 void bellman_ford_constrained_timed(std::vector<std::vector<tii>> &graph,
                               std::vector<std::vector<int>> &d,
                               std::vector<std::vector<pii>> &pred, int source,
@@ -124,4 +497,319 @@ void bellman_ford_constrained_timed(std::vector<std::vector<tii>> &graph,
 
   stop = high_resolution_clock::now();
   computation_time = duration_cast<nanoseconds>(stop - start).count();
-}
\ No newline at end of file
+}
+
+/* Compute the layer 'delay' of the above dynamic programming in the ring buffer
+ * 'ring' which holds the last 'window' layers (each one of size n + 1), the
+ * layer l being stored at the offset (l % window) * (n + 1). The predecessors
+ * are stored in 'pred' (of size n + 1) if it's not null.
+ */
+static void constrained_layer(std::vector<std::vector<tii>> &graph,
+                              std::vector<int> &ring, int window, int delay,
+                              int source, pii *pred) {
+  int n = graph.size() - 1;
+  int *layer = &ring[(delay % window) * (n + 1)], *prev, p;
+  std::fill(layer, layer + n + 1, INT_MAX);
+  layer[source] = 0;
+  if (pred)
+    pred[source] = {source, 0};
+
+  bool relaxation = true;
+  for (int _ = 1; _ < n && relaxation; ++_) {
+    relaxation = false;
+    for (int u = 1; u <= n; ++u) {
+      for (auto const &[w, z, v] : graph[u]) {
+        if (z <= delay) {
+          prev = &ring[((delay - z) % window) * (n + 1)];
+          if (prev[u] < INT_MAX && (p = prev[u] + w) < layer[v]) {
+            layer[v] = p;
+            if (pred)
+              pred[v] = {u, delay - z};
+            relaxation = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+/* A low-memory version of 'bellman_ford_constrained': only a sliding window of
+ * (z_max + 1) delay layers is kept (z_max being the maximum delay of an edge)
+ * together with a checkpoint of this window every 'interval' layers. The path
+ * is then rebuilt backwards segment by segment, each segment being recomputed
+ * from its checkpoint with its predecessors. The peak memory is
+ *   O(n (z_max (b / interval + 1) + interval))
+ * instead of O(n b), i.e. O(n z_max sqrt(b)) for interval = sqrt(b), at the
+ * cost of (at most) one more computation of the layers.
+ *
+ * As in 'main.cpp', the returned path is the one of minimal delay (which is
+ * stored in 'delay'), its length is returned (INT_MAX and an empty path if the
+ * target can't be reached within the bound b). The number of bytes used by the
+ * dynamic programming is stored in 'memory'.
+ */
+static int checkpointed_search(std::vector<std::vector<tii>> &graph,
+                               std::vector<int> &path, int &delay, int source,
+                               int target, int b, int interval,
+                               long long int &memory,
+                               std::vector<int> &ring,
+                               std::vector<std::vector<int>> &checkpoints,
+                               int window) {
+  int n = graph.size() - 1;
+  int length = INT_MAX;
+  path.clear();
+  delay = -1;
+
+  // Forward pass (distances only).
+  for (int l = 0; l <= b && delay < 0; ++l) {
+    if (l % interval == 0) {
+      checkpoints[l / interval] = ring;
+      memory += (long long int)ring.size() * sizeof(int);
+    }
+    constrained_layer(graph, ring, window, l, source, nullptr);
+    if (ring[(l % window) * (n + 1) + target] < INT_MAX) {
+      delay = l;
+      length = ring[(l % window) * (n + 1) + target];
+    }
+  }
+  if (delay < 0)
+    return length;
+
+  // Backward pass: recompute the segment [c, l] from its checkpoint and follow
+  // the predecessors until the path leaves the segment.
+  std::vector<pii> pred((size_t)std::min(interval, delay + 1) * (n + 1));
+  memory += (long long int)pred.size() * sizeof(pii);
+  int v = target, l = delay;
+  while (v != source) {
+    int c = l - l % interval;
+    ring = checkpoints[c / interval];
+    for (int k = c; k <= l; ++k)
+      constrained_layer(graph, ring, window, k, source,
+                        &pred[(size_t)(k - c) * (n + 1)]);
+    while (v != source && l >= c) {
+      path.push_back(v);
+      std::tie(v, l) = pred[(size_t)(l - c) * (n + 1) + v];
+    }
+  }
+  path.push_back(source);
+  std::reverse(path.begin(), path.end());
+  return length;
+}
+
+/* Allocate the sliding window and the checkpoints of the above search.
+ */
+static int checkpointed_window(std::vector<std::vector<tii>> &graph, int b,
+                               int interval, std::vector<int> &ring,
+                               std::vector<std::vector<int>> &checkpoints,
+                               long long int &memory) {
+  int n = graph.size() - 1, window = 1;
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u])
+      window = std::max(window, std::min(z, b) + 1);
+  }
+  ring.assign((size_t)window * (n + 1), INT_MAX);
+  checkpoints.assign(b / interval + 1, {});
+  memory = (long long int)ring.size() * sizeof(int);
+  return window;
+}
+
+int bellman_ford_constrained_checkpointed(std::vector<std::vector<tii>> &graph,
+                                          std::vector<int> &path, int &delay,
+                                          int source, int target, int b,
+                                          int interval, long long int &memory) {
+  std::vector<int> ring;
+  std::vector<std::vector<int>> checkpoints;
+  int window = checkpointed_window(graph, b, interval, ring, checkpoints, memory);
+  return checkpointed_search(graph, path, delay, source, target, b, interval,
+                             memory, ring, checkpoints, window);
+}
+
+int bellman_ford_constrained_checkpointed_timed(
+    std::vector<std::vector<tii>> &graph, std::vector<int> &path, int &delay,
+    int source, int target, int b, int interval, long long int &memory,
+    long long int &preprocess_time, long long int &computation_time) {
+  auto start = high_resolution_clock::now();
+  std::vector<int> ring;
+  std::vector<std::vector<int>> checkpoints;
+  int window = checkpointed_window(graph, b, interval, ring, checkpoints, memory);
+
+  auto stop = high_resolution_clock::now();
+  preprocess_time = duration_cast<nanoseconds>(stop - start).count();
+
+  start = high_resolution_clock::now();
+  int length = checkpointed_search(graph, path, delay, source, target, b,
+                                   interval, memory, ring, checkpoints, window);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+  return length;
+}
+
+/* Best label of a vertex reached by one edge from a label of delay <= b / 2
+ * (see below): the delay, the length and the label it comes from.
+ */
+struct frontier_label {
+  int delay = INT_MAX, length = INT_MAX, u = 0, l = 0;
+};
+
+/* One half of the bidirectional search: a Dijkstra-like search from 'root' on
+ * the labels of delay <= 'limit' (on the reverse graph for the backward half,
+ * 'pred' then stores the next vertex towards the target). When 'frontier' is
+ * given, the labels leaving the half by one edge (with a delay <= b) are kept
+ * in it, only the best one (smallest delay, then length) per vertex.
+ */
+static void half_search(std::vector<std::vector<tii>> &graph,
+                        std::vector<std::vector<int>> &d,
+                        std::vector<std::vector<pii>> &pred, int root,
+                        int limit, int b,
+                        std::vector<frontier_label> *frontier) {
+  d[root][0] = 0;
+  std::priority_queue<tii, std::vector<tii>, std::greater<tii>> pq(
+      {}, {{0, 0, root}});
+
+  int u, dist, l, delay;
+  while (!pq.empty()) {
+    std::tie(l, dist, u) = pq.top();
+    pq.pop();
+    if (dist > d[u][l])
+      continue;
+    for (auto const &[w, z, v] : graph[u]) {
+      delay = l + z;
+      if (delay <= limit) {
+        if (relax_delay(u, v, w, delay, l, d, pred))
+          pq.push({delay, d[v][delay], v});
+      } else if (frontier && delay <= b) {
+        auto &f = (*frontier)[v];
+        if (std::make_pair(delay, dist + w) < std::make_pair(f.delay, f.length))
+          f = {delay, dist + w, u, l};
+      }
+    }
+  }
+}
+
+/* Bidirectional (meet-in-the-middle) variant of the constrained Dijkstra: the
+ * forward half explores the labels of delay <= h = b / 2 from the source and
+ * the backward half the labels of delay <= b - h towards the target, on two
+ * threads. Any path of delay <= b has a vertex where the prefix delay is <= h
+ * or has just crossed h by one edge (a frontier label), from which the suffix
+ * delay is <= b - h: the path is found by joining both halves at that vertex.
+ *
+ * The labels of each half at a vertex, sorted by (delay, length), are merged:
+ * as in 'main.cpp' the path of minimal delay (then minimal length) is kept, so
+ * the best join at a vertex pairs the heads of both sides. The path, its delay
+ * and its length are returned as in 'bellman_ford_constrained_checkpointed'.
+ */
+static int bidirectional_search(std::vector<std::vector<tii>> &graph,
+                                std::vector<std::vector<tii>> &reverse,
+                                std::vector<int> &path, int &delay,
+                                int source, int target, int b,
+                                std::vector<std::vector<int>> &df,
+                                std::vector<std::vector<pii>> &pf,
+                                std::vector<std::vector<int>> &db,
+                                std::vector<std::vector<pii>> &pb,
+                                std::vector<frontier_label> &frontier) {
+  int n = graph.size() - 1, h = b / 2;
+  std::thread forward(half_search, std::ref(graph), std::ref(df), std::ref(pf),
+                      source, h, b, &frontier);
+  half_search(reverse, db, pb, target, b - h, b, nullptr);
+  forward.join();
+
+  // Join: the head of the forward labels of v (the table or the frontier) and
+  // the head of its backward labels.
+  int length = INT_MAX, meet = 0, lf = -1, lb = -1;
+  bool crossed = false;
+  delay = -1;
+  for (int v = 1; v <= n; ++v) {
+    int i = 0, j = 0;
+    while (i <= h && df[v][i] == INT_MAX)
+      ++i;
+    while (j <= b - h && db[v][j] == INT_MAX)
+      ++j;
+    if (j > b - h)
+      continue;
+    bool through = i > h;
+    int fd = through ? frontier[v].delay : i;
+    int fl = through ? frontier[v].length : df[v][i];
+    if (fd == INT_MAX || fd + j > b)
+      continue;
+    std::pair<int, int> key = {fd + j, fl + db[v][j]};
+    if (delay < 0 || key < std::make_pair(delay, length)) {
+      std::tie(delay, length) = key;
+      meet = v, lf = fd, lb = j, crossed = through;
+    }
+  }
+  path.clear();
+  if (delay < 0)
+    return INT_MAX;
+
+  // Forward part (through the frontier label if needed), then backward part.
+  int v = meet, l = lf;
+  if (crossed) {
+    path.push_back(v);
+    v = frontier[meet].u, l = frontier[meet].l;
+  }
+  path_delay(pf, path, source, v, l);
+  for (v = meet, l = lb; v != target;) {
+    std::tie(v, l) = pb[v][l];
+    path.push_back(v);
+  }
+  return length;
+}
+
+/* Allocate the tables of both halves and build the reverse graph.
+ */
+static void bidirectional_tables(std::vector<std::vector<tii>> &graph,
+                                 std::vector<std::vector<tii>> &reverse, int b,
+                                 std::vector<std::vector<int>> &df,
+                                 std::vector<std::vector<pii>> &pf,
+                                 std::vector<std::vector<int>> &db,
+                                 std::vector<std::vector<pii>> &pb,
+                                 std::vector<frontier_label> &frontier,
+                                 long long int &memory) {
+  int n = graph.size() - 1, h = b / 2;
+  reverse.assign(n + 1, {});
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u])
+      reverse[v].push_back({w, z, u});
+  }
+  df.assign(n + 1, std::vector<int>(h + 1, INT_MAX));
+  pf.assign(n + 1, std::vector<pii>(h + 1));
+  db.assign(n + 1, std::vector<int>(b - h + 1, INT_MAX));
+  pb.assign(n + 1, std::vector<pii>(b - h + 1));
+  frontier.assign(n + 1, {});
+  memory = (long long int)(n + 1) * (b + 2) * (sizeof(int) + sizeof(pii)) +
+           (long long int)(n + 1) * sizeof(frontier_label);
+}
+
+int dijkstra_constrained_bidirectional(std::vector<std::vector<tii>> &graph,
+                                       std::vector<int> &path, int &delay,
+                                       int source, int target, int b,
+                                       long long int &memory) {
+  std::vector<std::vector<tii>> reverse;
+  std::vector<std::vector<int>> df, db;
+  std::vector<std::vector<pii>> pf, pb;
+  std::vector<frontier_label> frontier;
+  bidirectional_tables(graph, reverse, b, df, pf, db, pb, frontier, memory);
+  return bidirectional_search(graph, reverse, path, delay, source, target, b,
+                              df, pf, db, pb, frontier);
+}
+
+int dijkstra_constrained_bidirectional_timed(
+    std::vector<std::vector<tii>> &graph, std::vector<int> &path, int &delay,
+    int source, int target, int b, long long int &memory,
+    long long int &preprocess_time, long long int &computation_time) {
+  auto start = high_resolution_clock::now();
+  std::vector<std::vector<tii>> reverse;
+  std::vector<std::vector<int>> df, db;
+  std::vector<std::vector<pii>> pf, pb;
+  std::vector<frontier_label> frontier;
+  bidirectional_tables(graph, reverse, b, df, pf, db, pb, frontier, memory);
+
+  auto stop = high_resolution_clock::now();
+  preprocess_time = duration_cast<nanoseconds>(stop - start).count();
+
+  start = high_resolution_clock::now();
+  int length = bidirectional_search(graph, reverse, path, delay, source,
+                                    target, b, df, pf, db, pb, frontier);
+  stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+  return length;
+}
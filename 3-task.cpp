@@ -1,26 +1,30 @@
 #include "tasks.hpp"
+#include "arena.hpp"
+#include "deadline.hpp"
 
 std::vector<std::vector<int>>
 dijkstra_k_shortest_paths(std::vector<std::vector<tii>> &graph, int source,
                           int k) {
+  // The paths in the queue live in the arena of the thread (see 'arena.hpp').
+  arena_scope scope;
   std::vector<std::vector<int>> shortest_paths;
-  std::priority_queue<std::vector<int>, std::vector<std::vector<int>>,
-                      std::greater<std::vector<int>>>
+  std::priority_queue<arena_vector<int>, arena_vector<arena_vector<int>>,
+                      std::greater<arena_vector<int>>>
       pq; // Priority queue of paths
 
   // Initialize path from source to itself
-  std::vector<int> initial_path = {0, source}; // {distance, vertex}
+  arena_vector<int> initial_path = {0, source}; // {distance, vertex}
   pq.push(initial_path);
 
   int u;
   while (!pq.empty() && (int)shortest_paths.size() < k) {
-    std::vector<int> current_path = pq.top();
+    arena_vector<int> current_path = pq.top();
     pq.pop();
 
     // If the current path is not the initial path, add it to the list of
     // shortest paths
     if (current_path.size() != 2)
-      shortest_paths.emplace_back(current_path);
+      shortest_paths.emplace_back(current_path.begin(), current_path.end());
 
     u = current_path.back();
     for (auto const &[w, _, v] : graph[u]) {
@@ -38,3 +42,50 @@ dijkstra_k_shortest_paths(std::vector<std::vector<tii>> &graph, int source,
   }
   return shortest_paths;
 }
+
+/* Anytime variant of the above algorithm: when the deadline expires (or the
+ * query is cancelled), the paths found so far are returned and the top of the
+ * queue is a lower bound on the length of the next ones.
+ */
+std::vector<std::vector<int>>
+dijkstra_k_shortest_paths_anytime(std::vector<std::vector<tii>> &graph,
+                                  int source, int k, query_deadline &deadline,
+                                  anytime_result &result) {
+  auto start = std::chrono::steady_clock::now();
+  result = {};
+  arena_scope scope;
+  std::vector<std::vector<int>> shortest_paths;
+  std::priority_queue<arena_vector<int>, arena_vector<arena_vector<int>>,
+                      std::greater<arena_vector<int>>>
+      pq;
+  pq.push(arena_vector<int>{0, source});
+
+  int u;
+  while (!pq.empty() && (int)shortest_paths.size() < k) {
+    if (deadline.expired()) {
+      result.length_bound = pq.top()[0];
+      return shortest_paths;
+    }
+    arena_vector<int> current_path = pq.top();
+    pq.pop();
+
+    if (current_path.size() != 2) {
+      shortest_paths.emplace_back(current_path.begin(), current_path.end());
+      if (result.first_time < 0)
+        result.first_time = elapsed_since(start);
+    }
+
+    u = current_path.back();
+    for (auto const &[w, _, v] : graph[u]) {
+      current_path[0] += w;
+      current_path.push_back(v);
+      pq.emplace(current_path);
+      current_path[0] -= w;
+      current_path.pop_back();
+    }
+  }
+  result.length_bound = pq.empty() ? INT_MAX : pq.top()[0];
+  result.optimal = true;
+  result.optimal_time = elapsed_since(start);
+  return shortest_paths;
+}
@@ -0,0 +1,82 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+arena::~arena() {
+  for (auto const &[p, size] : chunks)
+    std::free(p);
+}
+
+/* Round 'bytes' up to its size class and return the index of the class:
+ * 'bytes / ALIGNMENT' in 'free_lists' up to MAX_POOLED bytes, otherwise the
+ * exponent of the power of two in 'large_free_lists'.
+ */
+size_t arena::size_class(size_t &bytes) {
+  bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  if (bytes == 0)
+    bytes = ALIGNMENT;
+  if (bytes <= MAX_POOLED)
+    return bytes / ALIGNMENT;
+  size_t exponent = 0;
+  while (((size_t)1 << exponent) < bytes)
+    ++exponent;
+  bytes = (size_t)1 << exponent;
+  return exponent;
+}
+
+void *arena::allocate(size_t bytes) {
+  ++allocations;
+  size_t index = size_class(bytes);
+  void *&list =
+      bytes <= MAX_POOLED ? free_lists[index] : large_free_lists[index];
+  if (list) {
+    void *p = list;
+    list = *static_cast<void **>(p);
+    return p;
+  }
+
+  // Move to the next chunk (allocated if needed) which is large enough.
+  while ((size_t)(end - cursor) < bytes) {
+    if (cursor)
+      ++chunk;
+    if (chunk == chunks.size()) {
+      size_t size = chunks.empty() ? CHUNK_SIZE : 2 * chunks.back().second;
+      size = std::max(size, bytes);
+      char *p = static_cast<char *>(std::aligned_alloc(ALIGNMENT, size));
+      if (!p)
+        throw std::bad_alloc();
+      chunks.push_back({p, size});
+      ++system_allocations;
+    }
+    cursor = chunks[chunk].first;
+    end = cursor + chunks[chunk].second;
+  }
+  void *p = cursor;
+  cursor += bytes;
+  return p;
+}
+
+void arena::deallocate(void *p, size_t bytes) {
+  size_t index = size_class(bytes);
+  void *&list =
+      bytes <= MAX_POOLED ? free_lists[index] : large_free_lists[index];
+  *static_cast<void **>(p) = list;
+  list = p;
+}
+
+void arena::release() {
+  chunk = 0;
+  cursor = end = nullptr;
+  if (!chunks.empty()) {
+    cursor = chunks[0].first;
+    end = cursor + chunks[0].second;
+  }
+  std::fill(std::begin(free_lists), std::end(free_lists), nullptr);
+  std::fill(std::begin(large_free_lists), std::end(large_free_lists), nullptr);
+}
+
+arena &thread_arena() {
+  static thread_local arena a;
+  return a;
+}
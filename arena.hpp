@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+/* A per-thread monotonic arena with size-class free lists (a pool), used for
+ * the scratch structures of the engines. Memory is bump-allocated from chunks
+ * which are kept across queries: releasing the arena at the end of a query is
+ * O(1) (the cursor goes back to the first chunk) and the next queries don't
+ * hit the system allocator anymore once the chunks are large enough. Freed
+ * blocks are recycled through the free lists: one per multiple of ALIGNMENT up
+ * to MAX_POOLED bytes, and above one per power of two (the larger blocks are
+ * rounded up to it, so that the buffers left by a growing vector are reused by
+ * the next ones of the same class).
+ */
+struct arena {
+  static const size_t ALIGNMENT = 16;
+  static const size_t MAX_POOLED = 512;
+  static const size_t CHUNK_SIZE = 1 << 16;
+
+  std::vector<std::pair<char *, size_t>> chunks;
+  size_t chunk = 0;
+  char *cursor = nullptr, *end = nullptr;
+  void *free_lists[MAX_POOLED / ALIGNMENT + 1] = {};
+  void *large_free_lists[64] = {};
+  int depth = 0;
+
+  // Counters: blocks served by the arena and chunks asked to the system.
+  long long int allocations = 0;
+  long long int system_allocations = 0;
+
+  ~arena();
+  static size_t size_class(size_t &bytes);
+  void *allocate(size_t bytes);
+  void deallocate(void *p, size_t bytes);
+  void release();
+};
+
+arena &thread_arena();
+
+/* The arena of the current thread is released when the outermost scope ends,
+ * every engine opens one so that nested calls share the same query.
+ */
+struct arena_scope {
+  arena_scope() { ++thread_arena().depth; }
+  ~arena_scope() {
+    arena &a = thread_arena();
+    if (--a.depth == 0)
+      a.release();
+  }
+};
+
+/* A stateless allocator over 'thread_arena()' for the standard containers.
+ */
+template <class T> struct arena_allocator {
+  typedef T value_type;
+
+  arena_allocator() = default;
+  template <class U> arena_allocator(const arena_allocator<U> &) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(thread_arena().allocate(n * sizeof(T)));
+  }
+  void deallocate(T *p, size_t n) { thread_arena().deallocate(p, n * sizeof(T)); }
+
+  template <class U> bool operator==(const arena_allocator<U> &) const {
+    return true;
+  }
+  template <class U> bool operator!=(const arena_allocator<U> &) const {
+    return false;
+  }
+};
+
+template <class T> using arena_vector = std::vector<T, arena_allocator<T>>;
+template <class T>
+using arena_unordered_set =
+    std::unordered_set<T, std::hash<T>, std::equal_to<T>, arena_allocator<T>>;
+template <class K, class V>
+using arena_map =
+    std::map<K, V, std::less<K>, arena_allocator<std::pair<const K, V>>>;
@@ -11,7 +11,9 @@ from scipy.ndimage.filters import gaussian_filter1d
 
 ALGO = {
     1: 'Constrained Dijkstra',
-    2: 'Constrained Bellman-Ford'
+    2: 'Constrained Bellman-Ford',
+    4: 'Constrained Dijkstra (bucket queue)',
+    6: 'Constrained Dijkstra (bidirectional)'
 }
 TIME_UNIT_µS = '$\mu \mathrm{s}$'
 TIME_UNIT_NS = '$\mathrm{ns}$'
@@ -86,7 +88,8 @@ def generate_chart(dataframe):
                loc='lower right',
                title_fontproperties={'weight': 'bold'},
                labels=[
-                   ALGO[1], '_hidden', ALGO[2]
+                   ALGO[1], '_hidden', ALGO[2], '_hidden', ALGO[4], '_hidden',
+                   ALGO[6]
                ])
     plt.xlabel('Path weight', fontweight='bold')
     plt.ylabel('Computation time (in ' + TIME_UNIT_NS + ')', fontweight='bold')
@@ -120,7 +123,8 @@ def generate_chart(dataframe):
                loc='lower right',
                title_fontproperties={'weight': 'bold'},
                labels=[
-                   ALGO[1], '_hidden', ALGO[2]
+                   ALGO[1], '_hidden', ALGO[2], '_hidden', ALGO[4], '_hidden',
+                   ALGO[6]
                ])
     plt.xlabel('Path weight', fontweight='bold')
     plt.ylabel('Execution time (in ' + TIME_UNIT_NS + ')', fontweight='bold')
@@ -152,7 +156,8 @@ def generate_chart(dataframe):
                loc='lower right',
                title_fontproperties={'weight': 'bold'},
                labels=[
-                   ALGO[1], '_hidden', ALGO[2]
+                   ALGO[1], '_hidden', ALGO[2], '_hidden', ALGO[4], '_hidden',
+                   ALGO[6]
                ])
     plt.xlabel('Path weight', fontweight='bold')
     plt.ylabel('Preprocessing time (in ' + TIME_UNIT_NS + ')', fontweight='bold')
@@ -0,0 +1,137 @@
+#include "tasks.hpp"
+#include "compressed.hpp"
+
+static void write_varint(std::vector<uint8_t> &bytes, unsigned int x) {
+  while (x >= 0x80) {
+    bytes.push_back((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  bytes.push_back(x);
+}
+
+/* Write x on 'width' bytes, 'false' is returned if it doesn't fit.
+ */
+static bool write_packed(std::vector<uint8_t> &bytes, long long int x,
+                         int width) {
+  if (x < 0 || x >= 1LL << (8 * width))
+    return false;
+  for (int i = 0; i < width; ++i)
+    bytes.push_back((x >> (8 * i)) & 0xff);
+  return true;
+}
+
+/* Smallest number of bytes able to hold the values of [0, range].
+ */
+static int packed_width(long long int range) {
+  int width = 0;
+  while (range > 0) {
+    ++width;
+    range >>= 8;
+  }
+  return width;
+}
+
+/* Append the encoding of the edges of u (sorted by neighbour) to 'bytes'. The
+ * offsets of the weights and delays from their minimum are computed on 64 bits
+ * (their range can exceed INT_MAX), 'false' is returned if one of them doesn't
+ * fit the packed width.
+ */
+static bool encode_edges(compressed_graph &cg, int u, std::vector<tii> &edges,
+                         std::vector<uint8_t> &bytes) {
+  int prev = u;
+  for (size_t i = 0; i < edges.size(); ++i) {
+    auto const &[w, z, v] = edges[i];
+    if (i == 0) {
+      int delta = v - u;
+      write_varint(bytes, delta >= 0 ? 2u * delta : 2u * (-delta - 1) + 1);
+    } else
+      write_varint(bytes, v - prev);
+    if (!write_packed(bytes, (long long int)w - cg.min_weight,
+                      cg.weight_bytes) ||
+        !write_packed(bytes, (long long int)z - cg.min_delay, cg.delay_bytes))
+      return false;
+    prev = v;
+  }
+  return true;
+}
+
+/* Build the compressed adjacency of the graph (see 'compressed.hpp'). The
+ * parallel edges are kept, their gap is 0. A first pass computes the size of
+ * the encoding, so that 'bytes' is allocated once at its exact size. If
+ * 'release', the edges of each vertex are sorted in place and freed once
+ * encoded (the graph is left empty): the peak memory is then about the size of
+ * the uncompressed graph plus the one of the compressed adjacency. 'false' is
+ * returned if a value doesn't fit the encoding (the adjacency is then
+ * incomplete).
+ */
+bool compress_graph(std::vector<std::vector<tii>> &graph, compressed_graph &cg,
+                    bool release) {
+  int n = graph.size() - 1;
+  long long int min_w = 0, max_w = 0, min_z = 0, max_z = 0;
+  bool first = true;
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u]) {
+      if (first || w < min_w)
+        min_w = w;
+      if (first || w > max_w)
+        max_w = w;
+      if (first || z < min_z)
+        min_z = z;
+      if (first || z > max_z)
+        max_z = z;
+      first = false;
+    }
+  }
+  cg.min_weight = min_w;
+  cg.min_delay = min_z;
+  cg.weight_bytes = packed_width(max_w - min_w);
+  cg.delay_bytes = packed_width(max_z - min_z);
+
+  // The edges of u sorted by neighbour (in place if 'release').
+  std::vector<tii> copy;
+  auto sorted_edges = [&graph, &copy, release](int u) -> std::vector<tii> & {
+    auto &edges = release ? graph[u] : (copy = graph[u]);
+    std::sort(edges.begin(), edges.end(), [](tii const &a, tii const &b) {
+      return std::get<2>(a) < std::get<2>(b);
+    });
+    return edges;
+  };
+
+  size_t size = 0;
+  std::vector<uint8_t> scratch;
+  for (int u = 1; u <= n; ++u) {
+    scratch.clear();
+    if (!encode_edges(cg, u, sorted_edges(u), scratch))
+      return false;
+    size += scratch.size();
+  }
+
+  cg.offsets.assign(n + 2, 0);
+  std::vector<uint8_t>().swap(cg.bytes);
+  cg.bytes.reserve(size);
+  for (int u = 1; u <= n; ++u) {
+    cg.offsets[u] = cg.bytes.size();
+    if (release) {
+      encode_edges(cg, u, graph[u], cg.bytes);
+      std::vector<tii>().swap(graph[u]);
+    } else
+      encode_edges(cg, u, sorted_edges(u), cg.bytes);
+  }
+  cg.offsets[n + 1] = cg.bytes.size();
+  return true;
+}
+
+/* Memory used by the compressed adjacency and by the uncompressed one (the
+ * vector headers included), in bytes.
+ */
+long long int compressed_graph_memory(compressed_graph &cg) {
+  return cg.offsets.capacity() * sizeof(size_t) +
+         cg.bytes.capacity() * sizeof(uint8_t) + sizeof(compressed_graph);
+}
+
+long long int graph_memory(std::vector<std::vector<tii>> &graph) {
+  long long int memory = sizeof(graph) + graph.capacity() * sizeof(graph[0]);
+  for (auto const &edges : graph)
+    memory += edges.capacity() * sizeof(tii);
+  return memory;
+}
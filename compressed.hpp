@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Compressed adjacency of a graph: the edges of u are the bytes
+ * [offsets[u], offsets[u + 1]) of 'bytes'. The neighbours are sorted and
+ * gap-encoded as varints (7 bits per byte, the high bit set on all the bytes
+ * but the last one): the first one relatively to u (zigzag encoded, so that a
+ * locality-friendly labelling gives small gaps), the next ones relatively to
+ * the previous neighbour. Each gap is followed by the weight and the delay,
+ * stored minus their minimum over the graph on the smallest number of bytes
+ * able to hold the range seen at compression time (possibly 0).
+ *
+ * Only Dijkstra ('dijkstra_compressed') and the constrained Dijkstra
+ * ('dijkstra_constrained_compressed') run on it, the other engines need the
+ * uncompressed graph.
+ */
+struct compressed_graph {
+  std::vector<size_t> offsets;
+  std::vector<uint8_t> bytes;
+  int weight_bytes = 0, delay_bytes = 0;
+  int min_weight = 0, min_delay = 0;
+};
+
+inline unsigned int read_varint(const uint8_t *&p) {
+  unsigned int x = *p & 0x7f;
+  for (int shift = 7; *p++ & 0x80; shift += 7)
+    x |= (unsigned int)(*p & 0x7f) << shift;
+  return x;
+}
+
+inline unsigned int read_packed(const uint8_t *&p, int width) {
+  unsigned int x = 0;
+  for (int i = 0; i < width; ++i)
+    x |= (unsigned int)p[i] << (8 * i);
+  p += width;
+  return x;
+}
+
+/* Decode the edges of u on the fly and call f(w, z, v) on each of them.
+ */
+template <class F>
+inline void for_each_edge(const compressed_graph &cg, int u, F f) {
+  const uint8_t *p = cg.bytes.data() + cg.offsets[u];
+  const uint8_t *end = cg.bytes.data() + cg.offsets[u + 1];
+  int v = u;
+  for (bool first = true; p < end; first = false) {
+    unsigned int gap = read_varint(p);
+    if (first)
+      v = u + ((gap & 1) ? -(int)(gap >> 1) - 1 : (int)(gap >> 1));
+    else
+      v += gap;
+    int w = (int)(cg.min_weight + (long long int)read_packed(p, cg.weight_bytes));
+    int z = (int)(cg.min_delay + (long long int)read_packed(p, cg.delay_bytes));
+    f(w, z, v);
+  }
+}
@@ -0,0 +1,420 @@
+#include "tasks.hpp"
+#include <chrono>
+#include <omp.h>
+using namespace std::chrono;
+
+/*
+  Customizable route planning (multilevel overlay graphs), see:
+    - D. Delling, A. V. Goldberg, T. Pajor and R. F. Werneck, "Customizable
+  route planning in road networks", Transportation Science 51(2), 2017.
+
+  The work is split in three phases:
+    - 'crp_partition' (metric-independent, done once): a nested partition of
+  the vertices in cells by recursive BFS-growing bisections, and the boundary
+  vertices of each cell at each level.
+    - 'crp_customize' (metric-dependent): the clique of each cell i.e. the
+  distances between its boundary vertices (inside the cell), computed level by
+  level, the cells of a level being processed in parallel.
+    - 'crp_query': a bidirectional Dijkstra on the overlays, the shortcuts of
+  the path being unpacked afterwards.
+  Levels are numbered from 1 (the finest cells) in the comments and from 0 in
+  the arrays.
+*/
+
+/* Split 'set' in two halves: the first half is grown by BFS (on the undirected
+ * graph restricted to 'set') from a pseudo-peripheral vertex, so that the
+ * halves are connected as much as possible and the cut is small. 'in_set' and
+ * 'seen' are stamp arrays and 'stamp' is incremented.
+ */
+static void bisect(std::vector<std::vector<int>> &adj, std::vector<int> &set,
+                   std::vector<int> &first, std::vector<int> &second,
+                   std::vector<int> &in_set, std::vector<int> &seen,
+                   int &stamp) {
+  first.clear();
+  second.clear();
+  int half = set.size() / 2;
+  int s = ++stamp;
+  for (auto const &x : set)
+    in_set[x] = s;
+
+  // Pseudo-peripheral vertex: the last one reached by a BFS.
+  std::vector<int> order = {set[0]};
+  int t = ++stamp;
+  seen[set[0]] = t;
+  for (size_t head = 0; head < order.size(); ++head) {
+    for (auto const &v : adj[order[head]]) {
+      if (in_set[v] == s && seen[v] != t) {
+        seen[v] = t;
+        order.push_back(v);
+      }
+    }
+  }
+  int start = order.back();
+
+  order.clear();
+  t = ++stamp;
+  size_t next_seed = 0;
+  for (int seed = start; (int)order.size() < half;) {
+    seen[seed] = t;
+    order.push_back(seed);
+    for (size_t head = order.size() - 1;
+         head < order.size() && (int)order.size() < half; ++head) {
+      for (auto const &v : adj[order[head]]) {
+        if (in_set[v] == s && seen[v] != t && (int)order.size() < half) {
+          seen[v] = t;
+          order.push_back(v);
+        }
+      }
+    }
+    // Disconnected set: continue from a vertex not reached yet.
+    while (next_seed < set.size() && seen[set[next_seed]] == t)
+      ++next_seed;
+    if (next_seed == set.size())
+      break;
+    seed = set[next_seed];
+  }
+
+  first = order;
+  for (auto const &x : set) {
+    if (seen[x] != t)
+      second.push_back(x);
+  }
+}
+
+/* Compute the nested partition: the vertices are recursively bisected D times
+ * where D is the smallest integer such that the cells of the finest level have
+ * at most 'cell_size' vertices (and D >= levels). The cell of v at the level l
+ * is then its D bits code without its l * (D / levels) last bits.
+ *
+ * The number of levels is capped at log2(n / cell_size) (at least 1) so that
+ * each level halves the cells at least once without making them smaller than
+ * 'cell_size', and D at 'MAX_DEPTH' so that the codes fit in an int (the
+ * finest cells are then larger than asked). The levels actually used are
+ * stored in 'ov.levels'.
+ */
+static const int MAX_DEPTH = 30;
+
+void crp_partition(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                   int cell_size, int levels) {
+  int n = graph.size() - 1, max_levels = 0;
+  while (max_levels < MAX_DEPTH &&
+         ((long long int)cell_size << (max_levels + 1)) <= n)
+    ++max_levels;
+  levels = std::max(1, std::min(levels, max_levels));
+  int depth = levels;
+  while (depth < MAX_DEPTH && ((long long int)cell_size << depth) < n)
+    ++depth;
+  int step = depth / levels;
+
+  std::vector<std::vector<int>> adj(n + 1);
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u]) {
+      adj[u].push_back(v);
+      adj[v].push_back(u);
+    }
+  }
+
+  std::vector<int> code(n + 1), in_set(n + 1), seen(n + 1);
+  std::vector<std::vector<int>> groups(1), next_groups;
+  for (int v = 1; v <= n; ++v)
+    groups[0].push_back(v);
+  int stamp = 0;
+  for (int _ = 0; _ < depth; ++_) {
+    next_groups.clear();
+    for (auto &group : groups) {
+      std::vector<int> first, second;
+      if (!group.empty())
+        bisect(adj, group, first, second, in_set, seen, stamp);
+      for (auto const &v : first)
+        code[v] = 2 * code[v];
+      for (auto const &v : second)
+        code[v] = 2 * code[v] + 1;
+      next_groups.push_back(std::move(first));
+      next_groups.push_back(std::move(second));
+    }
+    groups.swap(next_groups);
+  }
+
+  ov.levels = levels;
+  ov.cells.assign(levels, 0);
+  ov.cell.assign(levels, std::vector<int>(n + 1));
+  ov.boundary.assign(levels, {});
+  ov.index.assign(levels, std::vector<int>(n + 1, -1));
+  for (int l = 0; l < levels; ++l) {
+    ov.cells[l] = 1 << (depth - l * step); // depth <= MAX_DEPTH < 31
+    for (int v = 0; v <= n; ++v)
+      ov.cell[l][v] = code[v] >> (l * step);
+
+    // Boundary vertices: endpoints of the edges between two cells.
+    std::vector<bool> boundary(n + 1);
+    for (int u = 1; u <= n; ++u) {
+      for (auto const &[w, z, v] : graph[u]) {
+        if (ov.cell[l][u] != ov.cell[l][v])
+          boundary[u] = boundary[v] = true;
+      }
+    }
+    ov.boundary[l].assign(ov.cells[l], {});
+    for (int v = 1; v <= n; ++v) {
+      if (boundary[v]) {
+        auto &b = ov.boundary[l][ov.cell[l][v]];
+        ov.index[l][v] = b.size();
+        b.push_back(v);
+      }
+    }
+  }
+}
+
+/* Dijkstra's algorithm inside the cell c of the level l (0-based) from the
+ * vertex 'from', on the base graph (l = 0) or on the overlay of the level l - 1
+ * (clique edges of the sub-cells and cut edges between them). 'pred' stores
+ * for each vertex its predecessor and the edge kind (0 for a base edge, L for
+ * a clique edge of the level L, 1-based). The search stops at 'target' (if
+ * it's not -1). The touched vertices are stored in 'touched'.
+ */
+static void cell_search(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                        int l, int c, int from, int target,
+                        std::vector<int> &dist, std::vector<pii> &pred,
+                        std::vector<int> &touched) {
+  std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq(
+      {}, {{0, from}});
+  dist[from] = 0;
+  touched.push_back(from);
+  auto relax = [&](int u, int v, int w, int kind) {
+    if (dist[u] + w < dist[v]) {
+      if (dist[v] == INT_MAX)
+        touched.push_back(v);
+      dist[v] = dist[u] + w;
+      pred[v] = {u, kind};
+      pq.push({dist[v], v});
+    }
+  };
+
+  int d, u;
+  while (!pq.empty()) {
+    std::tie(d, u) = pq.top();
+    pq.pop();
+    if (d > dist[u])
+      continue;
+    if (u == target)
+      break;
+
+    if (l == 0) {
+      for (auto const &[w, z, v] : graph[u]) {
+        if (ov.cell[0][v] == c)
+          relax(u, v, w, 0);
+      }
+    } else {
+      int sub = ov.cell[l - 1][u], i = ov.index[l - 1][u];
+      auto &b = ov.boundary[l - 1][sub];
+      auto &clique = ov.clique[l - 1][sub];
+      int k = b.size();
+      for (int j = 0; j < k; ++j) {
+        if (j != i && clique[i * k + j] < INT_MAX)
+          relax(u, b[j], clique[i * k + j], l);
+      }
+      for (auto const &[w, z, v] : graph[u]) {
+        if (ov.cell[l - 1][v] != sub && ov.cell[l][v] == c)
+          relax(u, v, w, 0);
+      }
+    }
+  }
+}
+
+/* Compute the cliques of all the cells with the current weights of the graph
+ * (this can be done again each time the weights change). The cells of a level
+ * are independent, they are processed in parallel. Return 'false' if a weight
+ * is negative.
+ */
+bool crp_customize(std::vector<std::vector<tii>> &graph, crp_overlay &ov) {
+  int n = graph.size() - 1;
+  ov.reverse.assign(n + 1, {});
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u]) {
+      if (w < 0)
+        return false;
+      ov.reverse[v].push_back({w, z, u});
+    }
+  }
+
+  ov.clique.assign(ov.levels, {});
+  for (int l = 0; l < ov.levels; ++l) {
+    ov.clique[l].assign(ov.cells[l], {});
+#pragma omp parallel
+    {
+      std::vector<int> dist(n + 1, INT_MAX), touched;
+      std::vector<pii> pred(n + 1);
+#pragma omp for schedule(dynamic)
+      for (int c = 0; c < ov.cells[l]; ++c) {
+        auto &b = ov.boundary[l][c];
+        int k = b.size();
+        auto &clique = ov.clique[l][c];
+        clique.assign(k * k, INT_MAX);
+        for (int i = 0; i < k; ++i) {
+          cell_search(graph, ov, l, c, b[i], -1, dist, pred, touched);
+          for (int j = 0; j < k; ++j)
+            clique[i * k + j] = dist[b[j]];
+          for (auto const &v : touched)
+            dist[v] = INT_MAX;
+          touched.clear();
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/* Append to 'path' the vertices after u of the shortest path from u to v
+ * represented by a clique edge of the level L (1-based).
+ */
+static void unpack(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                   int u, int v, int L, std::vector<int> &dist,
+                   std::vector<pii> &pred, std::vector<int> &path) {
+  std::vector<int> touched;
+  cell_search(graph, ov, L - 1, ov.cell[L - 1][u], u, v, dist, pred, touched);
+  std::vector<pii> chain;
+  for (int x = v; x != u; x = pred[x].first)
+    chain.push_back({x, pred[x].second});
+  for (auto const &x : touched)
+    dist[x] = INT_MAX;
+
+  for (int i = chain.size() - 1; i >= 0; --i) {
+    if (chain[i].second == 0)
+      path.push_back(chain[i].first);
+    else
+      unpack(graph, ov, path.back(), chain[i].first, chain[i].second, dist,
+             pred, path);
+  }
+}
+
+/* Bidirectional multilevel query. A vertex v is scanned at the highest level L
+ * at which its cell contains neither the source nor the target (L = 0 if there
+ * is none): then only the clique edges of its cell and the edges leaving it are
+ * relaxed. As the other engines, d[target] is the distance and 'pred' is filled
+ * along the (unpacked) path.
+ */
+void crp_query(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+               std::vector<int> &d, std::vector<int> &pred, int source,
+               int target) {
+  int n = graph.size() - 1;
+  d[source] = 0;
+  if (source == target)
+    return;
+
+  auto level = [&](int v) {
+    for (int l = ov.levels - 1; l >= 0; --l) {
+      if (ov.cell[l][v] != ov.cell[l][source] &&
+          ov.cell[l][v] != ov.cell[l][target])
+        return l + 1;
+    }
+    return 0;
+  };
+
+  std::vector<int> dist[2] = {std::vector<int>(n + 1, INT_MAX),
+                              std::vector<int>(n + 1, INT_MAX)};
+  std::vector<pii> link[2] = {std::vector<pii>(n + 1), std::vector<pii>(n + 1)};
+  std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq[2];
+  dist[0][source] = dist[1][target] = 0;
+  pq[0].push({0, source});
+  pq[1].push({0, target});
+
+  int mu = INT_MAX, meet = -1, side, l, u;
+  auto relax = [&](int u, int v, int w, int kind) {
+    if (dist[side][u] + w < dist[side][v]) {
+      dist[side][v] = dist[side][u] + w;
+      link[side][v] = {u, kind};
+      pq[side].push({dist[side][v], v});
+      if (dist[1 - side][v] < INT_MAX && dist[side][v] + dist[1 - side][v] < mu) {
+        mu = dist[side][v] + dist[1 - side][v];
+        meet = v;
+      }
+    }
+  };
+
+  while (true) {
+    long long int top[2];
+    for (int i = 0; i < 2; ++i)
+      top[i] = pq[i].empty() ? INT_MAX : pq[i].top().first;
+    if (top[0] + top[1] >= mu || (pq[0].empty() && pq[1].empty()))
+      break;
+    side = top[0] <= top[1] ? 0 : 1;
+    std::tie(l, u) = pq[side].top();
+    pq[side].pop();
+    if (l > dist[side][u])
+      continue;
+
+    int L = level(u);
+    auto &edges = side == 0 ? graph[u] : ov.reverse[u];
+    if (L == 0) {
+      for (auto const &[w, z, v] : edges)
+        relax(u, v, w, 0);
+    } else {
+      int c = ov.cell[L - 1][u], i = ov.index[L - 1][u];
+      auto &b = ov.boundary[L - 1][c];
+      auto &clique = ov.clique[L - 1][c];
+      int k = b.size(), w;
+      for (int j = 0; j < k; ++j) {
+        w = side == 0 ? clique[i * k + j] : clique[j * k + i];
+        if (j != i && w < INT_MAX)
+          relax(u, b[j], w, L);
+      }
+      for (auto const &[w, z, v] : edges) {
+        if (ov.cell[L - 1][v] != c)
+          relax(u, v, w, 0);
+      }
+    }
+  }
+  if (meet < 0)
+    return;
+  d[target] = mu;
+
+  // Unpack the forward part (from the source to the meeting vertex)...
+  std::vector<int> scratch(n + 1, INT_MAX), path = {source};
+  std::vector<pii> scratch_pred(n + 1), chain;
+  for (int v = meet; v != source; v = link[0][v].first)
+    chain.push_back({v, link[0][v].second});
+  for (int i = chain.size() - 1; i >= 0; --i) {
+    if (chain[i].second == 0)
+      path.push_back(chain[i].first);
+    else
+      unpack(graph, ov, path.back(), chain[i].first, chain[i].second, scratch,
+             scratch_pred, path);
+  }
+  // ... then the backward part (from the meeting vertex to the target).
+  for (int v = meet; v != target; v = link[1][v].first) {
+    if (link[1][v].second == 0)
+      path.push_back(link[1][v].first);
+    else
+      unpack(graph, ov, v, link[1][v].first, link[1][v].second, scratch,
+             scratch_pred, path);
+  }
+  for (size_t i = 1; i < path.size(); ++i)
+    pred[path[i]] = path[i - 1];
+}
+
+void crp_query_timed(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                     std::vector<int> &d, std::vector<int> &pred, int source,
+                     int target, long long int &preprocess_time,
+                     long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  crp_query(graph, ov, d, pred, source, target);
+  auto stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Memory used by the overlay (partition, boundaries and cliques) in bytes, the
+ * total number of boundary vertices is stored in 'boundary'.
+ */
+long long int crp_overlay_memory(crp_overlay &ov, long long int &boundary) {
+  long long int memory = 0;
+  boundary = 0;
+  for (int l = 0; l < ov.levels; ++l) {
+    memory += (ov.cell[l].size() + ov.index[l].size()) * sizeof(int);
+    for (int c = 0; c < ov.cells[l]; ++c) {
+      boundary += ov.boundary[l][c].size();
+      memory += (ov.boundary[l][c].size() + ov.clique[l][c].size()) *
+                sizeof(int);
+    }
+  }
+  return memory;
+}
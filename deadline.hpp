@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+/* Latency budget of a query: a deadline (none if the budget is <= 0) and an
+ * optional cancellation token set by another thread. 'expired' is called in
+ * the hot loops of the anytime engines: the clock and the token are only read
+ * every CHECK_PERIOD calls, and once expired it stays expired.
+ */
+struct query_deadline {
+  static const unsigned int CHECK_PERIOD = 256;
+
+  std::chrono::steady_clock::time_point end =
+      std::chrono::steady_clock::time_point::max();
+  const std::atomic<bool> *cancel = nullptr;
+  unsigned int ticks = 0;
+  bool over = false;
+
+  query_deadline() = default;
+  query_deadline(long long int ms, const std::atomic<bool> *cancel = nullptr)
+      : cancel(cancel) {
+    if (ms > 0)
+      end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  }
+
+  bool expired() {
+    if (over || ++ticks % CHECK_PERIOD)
+      return over;
+    over = (cancel && cancel->load(std::memory_order_relaxed)) ||
+           std::chrono::steady_clock::now() >= end;
+    return over;
+  }
+};
+
+/* What an anytime engine reports besides its best result so far: whether the
+ * result is proven optimal, a lower bound on the optimum (the (delay, length)
+ * pair for task 2, only the length for task 3) and the times (in ns since the
+ * start of the query) to the first result and to the proof of optimality (-1
+ * if they didn't happen before the deadline).
+ */
+struct anytime_result {
+  bool optimal = false;
+  int delay_bound = 0, length_bound = 0;
+  long long int first_time = -1, optimal_time = -1;
+};
+
+inline long long int
+elapsed_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
@@ -0,0 +1,302 @@
+#include "tasks.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <omp.h>
+using namespace std::chrono;
+
+/* Distance between 'source' and 'target' through the labels out(source) and
+ * in(target): both are sorted by hub rank, so it's a merge of the two arrays.
+ * The rank of the best hub is stored in 'hub' (-1 if there's none).
+ */
+static int merge_labels(std::vector<hub_label> &out, std::vector<hub_label> &in,
+                        int &hub) {
+  int best = INT_MAX;
+  hub = -1;
+  size_t i = 0, j = 0;
+  while (i < out.size() && j < in.size()) {
+    if (out[i].hub < in[j].hub)
+      ++i;
+    else if (out[i].hub > in[j].hub)
+      ++j;
+    else {
+      if (out[i].dist + in[j].dist < best) {
+        best = out[i].dist + in[j].dist;
+        hub = out[i].hub;
+      }
+      ++i, ++j;
+    }
+  }
+  return best;
+}
+
+/* One pruned Dijkstra of the pruned landmark labeling from the vertex of rank
+ * 'rank', on the graph (forward: adds the labels in(v)) or on the reverse
+ * graph (backward: adds the labels out(v)). A vertex v reached at distance δ
+ * is pruned when the labels already give a distance <= δ between the hub and
+ * v. 'dist', 'parent' (of size n + 1) and 'hub_dist' (of size n) are scratch
+ * arrays which are left clean.
+ */
+static void pruned_search(std::vector<std::vector<pii>> &edges, hub_labels &hl,
+                          int rank, bool forward, std::vector<int> &dist,
+                          std::vector<int> &parent,
+                          std::vector<int> &hub_dist) {
+  int h = hl.order[rank];
+  auto &labels = forward ? hl.in : hl.out;
+  auto &own = forward ? hl.out[h] : hl.in[h];
+  for (auto const &e : own)
+    hub_dist[e.hub] = e.dist;
+
+  std::vector<int> touched = {h};
+  std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq(
+      {}, {{0, h}});
+  dist[h] = 0;
+  parent[h] = h;
+  int l, v, best;
+  while (!pq.empty()) {
+    std::tie(l, v) = pq.top();
+    pq.pop();
+    if (l > dist[v])
+      continue;
+
+    if (v != h) {
+      best = INT_MAX;
+      for (auto const &e : labels[v]) {
+        if (hub_dist[e.hub] < INT_MAX)
+          best = std::min(best, hub_dist[e.hub] + e.dist);
+      }
+      if (best <= l)
+        continue;
+      labels[v].push_back({rank, l, parent[v]});
+    }
+
+    for (auto const &[w, u] : edges[v]) {
+      if (l + w < dist[u]) {
+        if (dist[u] == INT_MAX)
+          touched.push_back(u);
+        dist[u] = l + w;
+        parent[u] = v;
+        pq.push({dist[u], u});
+      }
+    }
+  }
+
+  for (auto const &u : touched)
+    dist[u] = INT_MAX;
+  for (auto const &e : own)
+    hub_dist[e.hub] = INT_MAX;
+}
+
+/* Importance of the vertices for the labeling order: the sum of their
+ * subtree sizes in the shortest path trees of a few random roots (a sampled
+ * betweenness), the vertices covering many shortest paths being the best hubs.
+ * The (in + out) degree breaks the ties.
+ */
+static void coverage_order(std::vector<std::vector<pii>> &forward,
+                           std::vector<int> &degree, std::vector<int> &order) {
+  int n = forward.size() - 1, samples = std::min(n, 16);
+  std::vector<long long int> coverage(n + 1);
+  std::vector<int> dist(n + 1), parent(n + 1), settled;
+  std::mt19937 generator(n);
+  for (int _ = 0; _ < samples; ++_) {
+    int root = std::uniform_int_distribution<int>(1, n)(generator), l, v;
+    std::fill(dist.begin(), dist.end(), INT_MAX);
+    std::priority_queue<pii, std::vector<pii>, std::greater<pii>> pq(
+        {}, {{0, root}});
+    dist[root] = 0;
+    parent[root] = 0;
+    settled.clear();
+    while (!pq.empty()) {
+      std::tie(l, v) = pq.top();
+      pq.pop();
+      if (l > dist[v])
+        continue;
+      settled.push_back(v);
+      for (auto const &[w, u] : forward[v]) {
+        if (l + w < dist[u]) {
+          dist[u] = l + w;
+          parent[u] = v;
+          pq.push({dist[u], u});
+        }
+      }
+    }
+    // Subtree sizes, in reverse settling order.
+    std::vector<long long int> size(n + 1);
+    for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+      size[*it] += 1;
+      coverage[*it] += size[*it];
+      if (parent[*it])
+        size[parent[*it]] += size[*it];
+    }
+  }
+
+  order.resize(n);
+  std::iota(order.begin(), order.end(), 1);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return coverage[a] > coverage[b] ||
+           (coverage[a] == coverage[b] && degree[a] > degree[b]);
+  });
+}
+
+/* Build a 2-hop labeling with the pruned landmark labeling of T. Akiba, Y.
+ * Iwata and Y. Yoshida, see:
+ *   - "Fast exact shortest-path distance queries on large networks via pruned
+ * landmark labeling", SIGMOD 2013.
+ *
+ * The hubs are processed in the order of 'coverage_order'. For each hub,
+ * the forward (in labels) and backward (out labels) pruned searches are
+ * independent and run on two threads. The weights must be non-negative:
+ * 'false' is returned otherwise.
+ */
+bool build_hub_labels(std::vector<std::vector<tii>> &graph, hub_labels &hl) {
+  int n = graph.size() - 1;
+  std::vector<std::vector<pii>> forward(n + 1), backward(n + 1);
+  std::vector<int> degree(n + 1);
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, _, v] : graph[u]) {
+      if (w < 0)
+        return false;
+      forward[u].push_back({w, v});
+      backward[v].push_back({w, u});
+      ++degree[u], ++degree[v];
+    }
+  }
+
+  coverage_order(forward, degree, hl.order);
+  hl.in.assign(n + 1, {});
+  hl.out.assign(n + 1, {});
+
+#pragma omp parallel num_threads(2)
+  {
+    int tid = omp_get_thread_num(), threads = omp_get_num_threads();
+    std::vector<int> dist(n + 1, INT_MAX), parent(n + 1), hub_dist(n, INT_MAX);
+    for (int rank = 0; rank < n; ++rank) {
+#pragma omp single
+      {
+        int h = hl.order[rank];
+        hl.in[h].push_back({rank, 0, h});
+        hl.out[h].push_back({rank, 0, h});
+      }
+      if (threads == 1 || tid == 0)
+        pruned_search(forward, hl, rank, true, dist, parent, hub_dist);
+      if (threads == 1 || tid == 1)
+        pruned_search(backward, hl, rank, false, dist, parent, hub_dist);
+#pragma omp barrier
+    }
+  }
+  return true;
+}
+
+/* Answer a query with the labels: d[target] is the distance and 'pred' is
+ * filled along the path (as the other engines do), which is retrieved through
+ * the parents stored in the labels of the best hub.
+ */
+void hub_labels_query(hub_labels &hl, std::vector<int> &d,
+                      std::vector<int> &pred, int source, int target) {
+  int rank;
+  d[source] = 0;
+  if (source == target)
+    return;
+  int dist = merge_labels(hl.out[source], hl.in[target], rank);
+  if (rank < 0)
+    return;
+  d[target] = dist;
+
+  auto find = [rank](std::vector<hub_label> &labels) -> hub_label & {
+    return *std::lower_bound(
+        labels.begin(), labels.end(), rank,
+        [](hub_label const &e, int r) { return e.hub < r; });
+  };
+
+  // From the source to the hub (out labels store the next vertex)...
+  int h = hl.order[rank], v = source, u;
+  while (v != h) {
+    u = find(hl.out[v]).parent;
+    pred[u] = v;
+    v = u;
+  }
+  // ... and from the hub to the target (in labels store the previous one).
+  for (v = target; v != h; v = pred[v])
+    pred[v] = find(hl.in[v]).parent;
+}
+
+void hub_labels_query_timed(hub_labels &hl, std::vector<int> &d,
+                            std::vector<int> &pred, int source, int target,
+                            long long int &preprocess_time,
+                            long long int &computation_time) {
+  preprocess_time = 0;
+  auto start = high_resolution_clock::now();
+  hub_labels_query(hl, d, pred, source, target);
+  auto stop = high_resolution_clock::now();
+  computation_time = duration_cast<nanoseconds>(stop - start).count();
+}
+
+/* Total number of label entries and the memory used by the labels (in bytes).
+ */
+long long int hub_labels_size(hub_labels &hl, long long int &memory) {
+  long long int entries = 0;
+  memory = hl.order.capacity() * sizeof(int);
+  for (size_t v = 0; v < hl.in.size(); ++v) {
+    entries += hl.in[v].size() + hl.out[v].size();
+    memory += (hl.in[v].capacity() + hl.out[v].capacity()) * sizeof(hub_label) +
+              2 * sizeof(std::vector<hub_label>);
+  }
+  return entries;
+}
+
+/* Binary file format: the magic "HLB2", n, the hash of the graph the labels
+ * were built from (see 'graph_hash' in 'index.cpp'), the order and then the in
+ * and out labels of each vertex (their size followed by the entries).
+ */
+static const char HUB_LABELS_MAGIC[4] = {'H', 'L', 'B', '2'};
+
+bool save_hub_labels(hub_labels &hl, std::string const &file_name,
+                     unsigned long long hash) {
+  std::ofstream file(file_name, std::ios::binary);
+  if (!file.is_open())
+    return false;
+  int n = hl.order.size(), size;
+  file.write(HUB_LABELS_MAGIC, 4);
+  file.write((char *)&n, sizeof(n));
+  file.write((char *)&hash, sizeof(hash));
+  file.write((char *)hl.order.data(), n * sizeof(int));
+  for (int v = 0; v <= n; ++v) {
+    for (auto *labels : {&hl.in[v], &hl.out[v]}) {
+      size = labels->size();
+      file.write((char *)&size, sizeof(size));
+      file.write((char *)labels->data(), size * sizeof(hub_label));
+    }
+  }
+  return file.good();
+}
+
+/* Load the labels saved by 'save_hub_labels', 'false' is returned if the file
+ * can't be read or if it was built from another graph (or another order of its
+ * vertices) than the one of hash 'hash' with n vertices.
+ */
+bool load_hub_labels(hub_labels &hl, std::string const &file_name, int n,
+                     unsigned long long hash) {
+  std::ifstream file(file_name, std::ios::binary);
+  char magic[4];
+  int size;
+  unsigned long long file_hash;
+  if (!file.is_open() || !file.read(magic, 4) ||
+      std::memcmp(magic, HUB_LABELS_MAGIC, 4) ||
+      !file.read((char *)&size, sizeof(size)) || size != n ||
+      !file.read((char *)&file_hash, sizeof(file_hash)) || file_hash != hash)
+    return false;
+  hl.order.resize(n);
+  hl.in.assign(n + 1, {});
+  hl.out.assign(n + 1, {});
+  file.read((char *)hl.order.data(), n * sizeof(int));
+  for (int v = 0; v <= n && file; ++v) {
+    for (auto *labels : {&hl.in[v], &hl.out[v]}) {
+      if (!file.read((char *)&size, sizeof(size)) || size < 0 || size > n)
+        return false;
+      labels->resize(size);
+      file.read((char *)labels->data(), size * sizeof(hub_label));
+    }
+  }
+  return (bool)file;
+}
@@ -0,0 +1,285 @@
+#include "tasks.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* File format (native endianness, the file is not meant to be moved between
+ * machines): a header, the section table and the sections. A section is the
+ * 'ints' array of a plan followed by its 'pairs' array (see 'attach_yen_plan'
+ * in '1-task.cpp'), it starts on a 64 bytes boundary. The header holds the hash
+ * of the graph the plans were built from and a checksum of the header and of
+ * the table; each entry of the table holds the checksum of its section.
+ */
+static const char INDEX_MAGIC[4] = {'P', 'I', 'D', 'X'};
+static const uint32_t INDEX_VERSION = 1;
+static const size_t INDEX_ALIGNMENT = 64;
+enum { INDEX_YEN = 1, INDEX_DELTA = 2 };
+
+struct index_header {
+  char magic[4];
+  uint32_t version;
+  uint64_t graph_hash;
+  int32_t n;
+  uint32_t sections;
+  uint64_t checksum;
+};
+
+struct index_entry {
+  int32_t type, param;
+  uint64_t offset, ints, pairs, checksum;
+};
+
+/* 64 bits FNV-1a hash of 'size' bytes, continued from 'hash'.
+ */
+static uint64_t fnv1a(const void *data, size_t size,
+                      uint64_t hash = 14695981039346656037ULL) {
+  auto bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static uint64_t table_checksum(index_header header, const index_entry *table) {
+  header.checksum = 0;
+  uint64_t hash = fnv1a(&header, sizeof(header));
+  return fnv1a(table, header.sections * sizeof(index_entry), hash);
+}
+
+static size_t aligned(size_t offset) {
+  return (offset + INDEX_ALIGNMENT - 1) / INDEX_ALIGNMENT * INDEX_ALIGNMENT;
+}
+
+/* Hash of the graph (n, and the edges of each vertex in order), the key of the
+ * index files built from it. The reordering of the vertices changes it.
+ */
+unsigned long long graph_hash(std::vector<std::vector<tii>> &graph) {
+  int n = graph.size() - 1, size, edge[3];
+  uint64_t hash = fnv1a(&n, sizeof(n));
+  for (int u = 1; u <= n; ++u) {
+    size = graph[u].size();
+    hash = fnv1a(&size, sizeof(size), hash);
+    for (auto const &[w, z, v] : graph[u]) {
+      edge[0] = w, edge[1] = z, edge[2] = v;
+      hash = fnv1a(edge, sizeof(edge), hash);
+    }
+  }
+  return hash;
+}
+
+void close_index(plan_index &index) {
+  if (index.data)
+    munmap((void *)index.data, index.size);
+  index.data = nullptr;
+  index.size = 0;
+  index.sections.clear();
+}
+
+/* Map an index file in memory. Only the header and the section table are read
+ * (the sections are paged in by the queries), so it takes a constant time
+ * whatever the size of the plans. 'false' is returned if the file can't be
+ * mapped, if it's not an index file of this version, if the checksum of its
+ * header and table doesn't match (corrupted file) or if it was built from
+ * another graph (stale file).
+ */
+bool open_index(plan_index &index, std::string const &file_name,
+                unsigned long long hash, int n) {
+  close_index(index);
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (!fstat(fd, &st) && (size_t)st.st_size >= sizeof(index_header))
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+  index.data = (const char *)data;
+  index.size = st.st_size;
+
+  index_header header;
+  std::memcpy(&header, index.data, sizeof(header));
+  auto table = (const index_entry *)(index.data + sizeof(header));
+  if (std::memcmp(header.magic, INDEX_MAGIC, 4) ||
+      header.version != INDEX_VERSION ||
+      sizeof(header) + header.sections * sizeof(index_entry) > index.size ||
+      header.checksum != table_checksum(header, table) ||
+      header.graph_hash != hash || header.n != n) {
+    close_index(index);
+    return false;
+  }
+  for (uint32_t i = 0; i < header.sections; ++i) {
+    auto const &e = table[i];
+    size_t size = e.ints * sizeof(int) + e.pairs * sizeof(pii);
+    if (e.offset % INDEX_ALIGNMENT || e.offset > index.size ||
+        size > index.size - e.offset) {
+      close_index(index);
+      return false;
+    }
+    index.sections.push_back({e.type, e.param, e.offset, e.ints, e.pairs,
+                              e.checksum});
+  }
+  return true;
+}
+
+/* Section of the index of this type and parameter, with the checksum of its
+ * bytes checked if 'verify' (a linear scan of the section).
+ */
+static const index_section *find_section(plan_index &index, int type,
+                                         int param, bool verify) {
+  for (auto const &s : index.sections) {
+    if (s.type == type && s.param == param) {
+      size_t size = s.ints * sizeof(int) + s.pairs * sizeof(pii);
+      if (verify && fnv1a(index.data + s.offset, size) != s.checksum)
+        return nullptr;
+      return &s;
+    }
+  }
+  return nullptr;
+}
+
+/* Whether the n + 2 CSR offsets are non-decreasing and within the 'pairs'
+ * edges of the section.
+ */
+static bool valid_offsets(const int *offsets, int n, size_t pairs) {
+  if (offsets[0] < 0 || (size_t)offsets[n + 1] > pairs)
+    return false;
+  for (int u = 0; u <= n; ++u) {
+    if (offsets[u] > offsets[u + 1])
+      return false;
+  }
+  return true;
+}
+
+/* Whether the edges (w, v) of the section lead to vertices of the graph.
+ */
+static bool valid_edges(const pii *edges, size_t pairs, int n) {
+  for (size_t i = 0; i < pairs; ++i) {
+    if (edges[i].second < 1 || edges[i].second > n)
+      return false;
+  }
+  return true;
+}
+
+/* Point the plan to its section of the index (no copy): 'false' is returned if
+ * the index has none or if its offsets, vertices or permutation are out of
+ * range (a scan of the section, about 10 times faster than its checksum). The
+ * weights are only covered by the checksum, checked if 'verify'. The plan is
+ * valid until the index is closed.
+ */
+bool index_yen_plan(plan_index &index, int n, yen_plan &plan, bool verify) {
+  auto s = find_section(index, INDEX_YEN, 0, verify);
+  if (!s || s->ints != (size_t)(n + 1) + 2 * (n + 2))
+    return false;
+  auto ints = (const int *)(index.data + s->offset);
+  auto pairs = (const pii *)(ints + s->ints);
+  for (int u = 0; u <= n; ++u) {
+    if (ints[u] < 0 || ints[u] > n)
+      return false;
+  }
+  if (!valid_offsets(ints + (n + 1), n, s->pairs) ||
+      !valid_offsets(ints + (n + 1) + (n + 2), n, s->pairs) ||
+      !valid_edges(pairs, s->pairs, n))
+    return false;
+  attach_yen_plan(plan, n, ints, pairs);
+  return true;
+}
+
+bool index_delta_plan(plan_index &index, int n, int delta, delta_plan &plan,
+                      bool verify) {
+  auto s = find_section(index, INDEX_DELTA, delta, verify);
+  if (!s || s->ints != 2 * (size_t)(n + 2))
+    return false;
+  auto ints = (const int *)(index.data + s->offset);
+  auto pairs = (const pii *)(ints + s->ints);
+  if (!valid_offsets(ints, n, s->pairs) ||
+      !valid_offsets(ints + (n + 2), n, s->pairs) ||
+      !valid_edges(pairs, s->pairs, n))
+    return false;
+  attach_delta_plan(plan, n, delta, ints, pairs);
+  return true;
+}
+
+/* Write the index file with the sections of 'index' (if it's mapped) and the
+ * plans 'yen' and 'delta' (if not null, built in memory), which replace the
+ * sections of the same plans. The file is written aside and then renamed, so
+ * that the processes which have mapped the previous one are not disturbed,
+ * 'index' included (it's left on the previous file).
+ */
+bool save_index(plan_index &index, std::string const &file_name,
+                unsigned long long hash, int n, yen_plan *yen,
+                delta_plan *delta) {
+  struct part {
+    index_entry entry;
+    const char *ints, *pairs;
+  };
+  std::vector<part> parts;
+  auto add = [&parts](int type, int param, const void *ints, size_t ints_size,
+                      const void *pairs, size_t pairs_size, uint64_t checksum) {
+    parts.push_back({{type, param, 0, ints_size, pairs_size, checksum},
+                     (const char *)ints, (const char *)pairs});
+  };
+  auto add_plan = [&add](int type, int param, std::vector<int> const &ints,
+                         std::vector<pii> const &pairs) {
+    uint64_t checksum = fnv1a(ints.data(), ints.size() * sizeof(int));
+    checksum = fnv1a(pairs.data(), pairs.size() * sizeof(pii), checksum);
+    add(type, param, ints.data(), ints.size(), pairs.data(), pairs.size(),
+        checksum);
+  };
+  // The sections carried over keep their checksum: it's not recomputed from
+  // their bytes, so that a corrupted one is still detected in the new file.
+  for (auto const &s : index.sections) {
+    if ((s.type == INDEX_YEN && yen) ||
+        (s.type == INDEX_DELTA && delta && s.param == delta->delta))
+      continue;
+    auto ints = index.data + s.offset;
+    add(s.type, s.param, ints, s.ints, ints + s.ints * sizeof(int), s.pairs,
+        s.checksum);
+  }
+  if (yen)
+    add_plan(INDEX_YEN, 0, yen->ints, yen->pairs);
+  if (delta)
+    add_plan(INDEX_DELTA, delta->delta, delta->ints, delta->pairs);
+
+  index_header header;
+  std::memcpy(header.magic, INDEX_MAGIC, 4);
+  header.version = INDEX_VERSION;
+  header.graph_hash = hash;
+  header.n = n;
+  header.sections = parts.size();
+  size_t offset = aligned(sizeof(header) + parts.size() * sizeof(index_entry));
+  std::vector<index_entry> table;
+  for (auto &p : parts) {
+    p.entry.offset = offset;
+    offset = aligned(offset + p.entry.ints * sizeof(int) +
+                     p.entry.pairs * sizeof(pii));
+    table.push_back(p.entry);
+  }
+  header.checksum = table_checksum(header, table.data());
+
+  std::string temporary = file_name + ".tmp";
+  std::ofstream file(temporary, std::ios::binary);
+  if (!file.is_open())
+    return false;
+  const char padding[INDEX_ALIGNMENT] = {};
+  file.write((char *)&header, sizeof(header));
+  file.write((char *)table.data(), table.size() * sizeof(index_entry));
+  for (auto const &p : parts) {
+    file.write(padding, p.entry.offset - (size_t)file.tellp());
+    file.write(p.ints, p.entry.ints * sizeof(int));
+    file.write(p.pairs, p.entry.pairs * sizeof(pii));
+  }
+  file.close();
+  if (!file || std::rename(temporary.c_str(), file_name.c_str())) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
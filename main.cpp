@@ -1,7 +1,11 @@
 #include "tasks.hpp"
+#include "arena.hpp"
+#include "compressed.hpp"
+#include "deadline.hpp"
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
+#include <numeric>
 #include <string>
 #include <thread>
 using namespace std::chrono;
@@ -13,15 +17,26 @@ long long int computation_time = 0;
 // The messages to print in the shell.
 std::string tasks = "Choose a task number: 1, 2, 3 or 4.";
 std::string task_1_algo =
-    "Choose an algorithm to apply:\n  - 1: Dijkstra\n  - 2: Dijkstra "
+    "Choose an algorithm to apply:\n  - 0: Automatic (graph profile and "
+    "calibration)\n  - 1: Dijkstra\n  - 2: Dijkstra "
     "parallel\n  - 3: Bellman-Ford (naive)\n  - 4: Bellman-Ford (optimized)\n  "
-    "- 5: Delta-stepping";
-std::string task_2_algo = "Choose an algorithm to apply:\n  - 1: "
-                          "Dijkstra-like\n  - 2: Bellman-Ford variant parallel";
+    "- 5: Delta-stepping\n  - 6: Bellman-Ford (subtree disassembly, negative "
+    "cycle detection)\n  - 7: Dijkstra (Johnson reweighting)\n  - 8: Hub "
+    "labeling (2-hop labels)\n  - 9: Customizable route planning (multilevel "
+    "overlay)\n  - 10: Dijkstra (compressed adjacency)";
+std::string task_2_algo =
+    "Choose an algorithm to apply:\n  - 1: Dijkstra-like\n  - 2: Bellman-Ford "
+    "variant parallel\n  - 3: Bellman-Ford variant (checkpointed, low memory)\n "
+    " - 4: Dijkstra-like (bucket queue)\n  - 5: Dijkstra-like (compressed "
+    "adjacency)\n  - 6: Dijkstra-like (bidirectional)";
 std::string task_3_k = "Choose the hyperparameter k.";
 std::string input = "Your choice: ";
 std::string repeat_message = "Number of repetitions.";
 std::string delta_stepping_hyperparameter = "Choose the hyperparameter delta.";
+std::string crp_cell_size = "Choose the size of the finest cells.";
+std::string crp_levels = "Choose the number of levels.";
+std::string checkpoint_interval =
+    "Choose the checkpoint interval (in delay layers, e.g. sqrt(b)).";
 
 /* The function is used to read the user input correctly given finite number of
  * outputs.
@@ -62,16 +77,105 @@ int read_int(std::string message) {
   return stoi(s);
 }
 
+/* Build the compressed adjacency of the graph (see 'compressed.hpp') and print
+ * its memory against the uncompressed one. Only the compressed engines (task 1
+ * algorithm 10 and task 2 algorithm 5) run after it, so the uncompressed graph
+ * is released while it's compressed.
+ */
+bool compress_and_report(std::vector<std::vector<tii>> &graph,
+                         compressed_graph &cg) {
+  long long int memory = graph_memory(graph);
+  auto start = high_resolution_clock::now();
+  if (!compress_graph(graph, cg, true)) {
+    printf("Error: the weights don't fit the compressed encoding.\n");
+    return false;
+  }
+  std::vector<std::vector<tii>>().swap(graph);
+  auto stop = high_resolution_clock::now();
+  std::cout << "Compression time: "
+            << duration_cast<nanoseconds>(stop - start).count() << "ns" << '\n'
+            << "Adjacency memory (in bytes): " << memory
+            << " uncompressed (released), " << compressed_graph_memory(cg)
+            << " compressed" << '\n'
+            << "Packed widths (in bytes): " << cg.weight_bytes << " (weights), "
+            << cg.delay_bytes << " (delays)" << std::endl;
+  return true;
+}
+
+/* Print the per-run cache misses ('-1' when the hardware counter is not
+ * available).
+ */
+void print_cache_misses(std::vector<long long int> &cache_misses) {
+  std::cout << '\n' << "Cache misses:";
+  for (auto &c : cache_misses)
+    std::cout << ' ' << c;
+}
+
+/* Print the per-run allocations served by the arena of the engines and the
+ * ones which reached the system allocator (see 'arena.hpp').
+ */
+void print_allocations(std::vector<pii> &allocations) {
+  std::cout << '\n' << "Arena allocations (served/system):";
+  for (auto const &[served, system] : allocations)
+    std::cout << ' ' << served << '/' << system;
+}
+
+/* Print the anytime report of each run (see 'deadline.hpp').
+ */
+void print_anytime(std::vector<anytime_result> &results) {
+  std::cout << '\n' << "Times to first result (in ns):";
+  for (auto const &r : results)
+    std::cout << ' ' << r.first_time;
+  std::cout << '\n' << "Times to optimal (in ns):";
+  for (auto const &r : results)
+    std::cout << ' ' << r.optimal_time;
+}
+
 /*
   This file serves as a router to call the different tasks.
 
   Usage:
-  ./main [input file]
+  ./main [input file] [--reorder=rcm|bfs|degree] [--serve=socket path]
+         [--workers=number of threads] [--hub-labels=labels file]
+         [--deadline=milliseconds] [--index=index file] [--verify-index]
+
+  The '--reorder' option relabels the vertices after loading for a better
+  memory locality; the sources, targets and paths are translated back and forth
+  so that the input and output still use the labels of the input file. When
+  it's given several times, the relabellings are applied in order.
+
+  The '--serve' option runs a query server on a Unix domain socket instead of
+  the prompts (see 'server.cpp' for the protocol).
+
+  The '--hub-labels' option gives the file from which the hub labels are
+  loaded (or in which they are saved once built, also when the file was built
+  from another graph or another '--reorder').
+
+  The '--deadline' option gives a latency budget to the queries of the task 2
+  (algorithms 1, 2, 4 and 5) and of the task 3: the anytime variants of the
+  engines return their best result when it expires, with a lower bound on the
+  optimum. The task 2 algorithms 3 and 6 exit with an error when a deadline is
+  given: the checkpointed one only rebuilds its path once all the layers are
+  computed, and the bidirectional one only has a path (and a bound) once its
+  two searches meet.
+
+  The '--index' option gives the file in which the plans of the task 1
+  (algorithms 4 and 5, also in the server) are stored, keyed by a hash of the
+  graph: they are
+  mapped from it when it has them, otherwise they are built and added to it (a
+  stale file, or a plan whose offsets or vertices are out of range, is
+  rebuilt). The weights of a mapped plan are not checked: '--verify-index' also
+  checks its checksum, so that any corruption of it is detected (and rebuilt).
 */
 int main(int argc, char **argv) {
   std::cin.tie(0)->sync_with_stdio(0);
   if (argc < 2)
-    printf("Not enough arguments.\nUsage: %s [input file]\n", argv[0]);
+    printf("Not enough arguments.\nUsage: %s [input file] "
+           "[--reorder=rcm|bfs|degree] [--serve=socket path] "
+           "[--workers=number of threads] [--hub-labels=labels file] "
+           "[--deadline=milliseconds] [--index=index file] "
+           "[--verify-index]\n",
+           argv[0]);
   else {
     std::ifstream file(argv[1]);
     if (file.is_open()) {
@@ -86,6 +190,71 @@ int main(int argc, char **argv) {
         graph[u].push_back({w, z, v});
       }
 
+      // Optional relabelling of the vertices, 'permutation' maps the labels of
+      // the input file to the internal ones and 'rev_permutation' goes back.
+      std::vector<int> permutation(n + 1), rev_permutation(n + 1);
+      std::iota(permutation.begin(), permutation.end(), 0);
+      std::iota(rev_permutation.begin(), rev_permutation.end(), 0);
+      std::string socket_path, labels_file, index_file;
+      bool verify_index = false;
+      long long int deadline_ms = 0;
+      int workers = std::max(1u, std::thread::hardware_concurrency());
+      for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option.rfind("--serve=", 0) == 0)
+          socket_path = option.substr(8);
+        else if (option.rfind("--hub-labels=", 0) == 0)
+          labels_file = option.substr(13);
+        else if (option.rfind("--index=", 0) == 0)
+          index_file = option.substr(8);
+        else if (option == "--verify-index")
+          verify_index = true;
+        else if (option.rfind("--deadline=", 0) == 0)
+          deadline_ms = atoll(option.substr(11).c_str());
+        else if (option.rfind("--workers=", 0) == 0)
+          workers = std::max(1, atoi(option.substr(10).c_str()));
+        else if (option.rfind("--reorder=", 0) == 0) {
+          std::string method = option.substr(10);
+          int bandwidth, new_bandwidth;
+          double span = average_edge_span(graph, bandwidth);
+          auto start = high_resolution_clock::now();
+          // The relabelling of this option is composed with the previous ones.
+          std::vector<int> step, rev_step;
+          if (!reorder_permutation(graph, method, step, rev_step)) {
+            printf("Error: unknown reordering method: %s\n", method.c_str());
+            return 1;
+          }
+          reorder_graph(graph, step);
+          for (int u = 1; u <= n; ++u) {
+            permutation[u] = step[permutation[u]];
+            rev_permutation[permutation[u]] = u;
+          }
+          auto stop = high_resolution_clock::now();
+          double new_span = average_edge_span(graph, new_bandwidth);
+          std::cout << "Reordering (" << method << ") time: "
+                    << duration_cast<nanoseconds>(stop - start).count()
+                    << "ns" << '\n'
+                    << "Average edge span: " << span << " -> " << new_span
+                    << '\n'
+                    << "Bandwidth: " << bandwidth << " -> " << new_bandwidth
+                    << '\n'
+                    << std::endl;
+        }
+      }
+      if (!socket_path.empty()) {
+        // The server maps its plans from the index file (a missing or stale
+        // one is rebuilt as the plans are built).
+        plan_index index;
+        unsigned long long hash = 0;
+        if (!index_file.empty()) {
+          hash = graph_hash(graph);
+          open_index(index, index_file, hash, n);
+        }
+        return run_server(graph, b, socket_path, workers, permutation,
+                          rev_permutation, index, index_file, hash,
+                          verify_index);
+      }
+
       // Reading the task number.
       int num = read_input(tasks, {"1", "2", "3", "4"}), algo;
 
@@ -98,6 +267,8 @@ int main(int argc, char **argv) {
       int target = read_input("Target (1 to " + std::to_string(n) + ").",
                               valid_vertices);
       int num_repeat = read_int(repeat_message);
+      source = permutation[source];
+      target = permutation[target];
 
       auto start = high_resolution_clock::now();
       auto stop = high_resolution_clock::now();
@@ -105,22 +276,155 @@ int main(int argc, char **argv) {
       std::vector<long long int> times;
       std::vector<long long int> preprocess_times;
       std::vector<long long int> computation_times;
+      std::vector<long long int> cache_misses;
+      std::vector<pii> allocations;
+      arena &scratch = thread_arena();
+      long long int served, system;
+      int counter;
       double total_time = 0.0;
       double total_preprocess_time = 0.0;
       double total_computation_time = 0.0;
 
       // Execute the selected task.
       if (num == 1) {
-        algo = read_input(task_1_algo, {"1", "2", "3", "4", "5"});
+        algo = read_input(task_1_algo,
+                          {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+                           "10"});
         int delta = 0;
-        if (algo == 5)
+        if (algo == 0) {
+          graph_profile profile;
+          std::string log;
+          start = high_resolution_clock::now();
+          profile_graph(graph, profile);
+          algo = auto_select_engine(graph, profile, source, delta, log);
+          stop = high_resolution_clock::now();
+          std::cout << log << '\n'
+                    << "Selection time: "
+                    << duration_cast<nanoseconds>(stop - start).count() << "ns"
+                    << std::endl;
+        } else if (algo == 5)
           delta = read_int(delta_stepping_hyperparameter);
-        std::vector<int> d(n + 1, INT_MAX), pred(n + 1);
+        std::vector<int> d(n + 1, INT_MAX), pred(n + 1), cycle;
+
+        // The Johnson potentials are computed once for all the queries.
+        std::vector<int> h;
+        std::vector<std::vector<tii>> reweighted;
+        if (algo == 7) {
+          start = high_resolution_clock::now();
+          if (johnson_potentials(graph, h, cycle))
+            johnson_reweight(graph, h, reweighted);
+          stop = high_resolution_clock::now();
+          std::cout << "Johnson preprocess time: "
+                    << duration_cast<nanoseconds>(stop - start).count() << "ns"
+                    << std::endl;
+          if (!cycle.empty())
+            num_repeat = 0;
+        }
+
+        // The hub labels are built (or loaded) once for all the queries.
+        hub_labels hl;
+        if (algo == 8) {
+          unsigned long long hash = labels_file.empty() ? 0 : graph_hash(graph);
+          start = high_resolution_clock::now();
+          bool loaded = !labels_file.empty() &&
+                        load_hub_labels(hl, labels_file, n, hash);
+          if (!loaded && !build_hub_labels(graph, hl)) {
+            printf("Error: hub labels need non-negative weights.\n");
+            return 1;
+          }
+          stop = high_resolution_clock::now();
+          if (!loaded && !labels_file.empty())
+            save_hub_labels(hl, labels_file, hash);
+          long long int memory, entries = hub_labels_size(hl, memory);
+          std::cout << "Hub labels " << (loaded ? "loading" : "preprocess")
+                    << " time: "
+                    << duration_cast<nanoseconds>(stop - start).count() << "ns"
+                    << '\n'
+                    << "Average label size: " << (double)entries / (2.0 * n)
+                    << '\n'
+                    << "Labels memory (in bytes): " << memory << std::endl;
+        }
+
+        // The partition is metric-independent, the customization has to be
+        // done again only when the weights change.
+        crp_overlay ov;
+        if (algo == 9) {
+          int cell_size = read_int(crp_cell_size);
+          int levels = read_int(crp_levels);
+          start = high_resolution_clock::now();
+          crp_partition(graph, ov, cell_size, levels);
+          stop = high_resolution_clock::now();
+          std::cout << "CRP partition time: "
+                    << duration_cast<nanoseconds>(stop - start).count() << "ns"
+                    << '\n'
+                    << "Levels: " << ov.levels << std::endl;
+          start = high_resolution_clock::now();
+          if (!crp_customize(graph, ov)) {
+            printf("Error: the overlay needs non-negative weights.\n");
+            return 1;
+          }
+          stop = high_resolution_clock::now();
+          long long int boundary, memory = crp_overlay_memory(ov, boundary);
+          std::cout << "CRP customization time: "
+                    << duration_cast<nanoseconds>(stop - start).count() << "ns"
+                    << '\n'
+                    << "Boundary vertices (all levels): " << boundary << '\n'
+                    << "Overlay memory (in bytes): " << memory << std::endl;
+        }
+
+        compressed_graph cg;
+        if (algo == 10 && !compress_and_report(graph, cg))
+          return 1;
+
+        // The derived graphs of the algorithms 4 and 5 are built once (or
+        // mapped from the index file), the runs below only time the queries.
+        yen_plan yp;
+        delta_plan dp;
+        plan_index index;
+        long long int prepare_time = 0;
+        if (algo == 4 || algo == 5) {
+          unsigned long long hash = 0;
+          if (!index_file.empty()) {
+            start = high_resolution_clock::now();
+            hash = graph_hash(graph);
+            stop = high_resolution_clock::now();
+            std::cout << "Graph hash time: "
+                      << duration_cast<nanoseconds>(stop - start).count()
+                      << "ns" << std::endl;
+          }
+          start = high_resolution_clock::now();
+          bool loaded =
+              !index_file.empty() && open_index(index, index_file, hash, n) &&
+              (algo == 4
+                   ? index_yen_plan(index, n, yp, verify_index)
+                   : index_delta_plan(index, n, delta, dp, verify_index));
+          if (!loaded && algo == 4)
+            prepare_yen(graph, yp);
+          else if (!loaded)
+            prepare_delta_stepping(graph, delta, dp);
+          stop = high_resolution_clock::now();
+          prepare_time = duration_cast<nanoseconds>(stop - start).count();
+          if (!index_file.empty()) {
+            if (loaded)
+              std::cout << "Plan mapped from the index file" << std::endl;
+            else if (save_index(index, index_file, hash, n,
+                                algo == 4 ? &yp : nullptr,
+                                algo == 5 ? &dp : nullptr))
+              std::cout << "Plan built and stored in the index file"
+                        << std::endl;
+            else
+              printf("Error: cannot write the index file: %s\n",
+                     index_file.c_str());
+          }
+        }
 
         for (int _ = 0; _ < num_repeat; ++_) {
           std::fill(d.begin(), d.end(), INT_MAX);
           std::fill(pred.begin(), pred.end(), 0);
 
+          served = scratch.allocations;
+          system = scratch.system_allocations;
+          counter = cache_misses_start();
           if (algo == 1) {
             start = high_resolution_clock::now();
             dijkstra_timed(graph, d, pred, source, target, preprocess_time,
@@ -137,15 +441,44 @@ int main(int argc, char **argv) {
             stop = high_resolution_clock::now();
           } else if (algo == 4) {
             start = high_resolution_clock::now();
-            bellman_ford_yen_timed(graph, d, pred, source, target,
+            bellman_ford_yen_prepared_timed(yp, d, pred, source, target,
+                                            preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 5) {
+            start = high_resolution_clock::now();
+            delta_stepping_prepared_timed(dp, d, pred, source, target,
+                                          preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 6) {
+            cycle.clear();
+            start = high_resolution_clock::now();
+            bellman_ford_tarjan_timed(graph, d, pred, source, target, cycle,
+                                      preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 7) {
+            start = high_resolution_clock::now();
+            dijkstra_johnson_timed(reweighted, h, d, pred, source, target,
+                                   preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 8) {
+            start = high_resolution_clock::now();
+            hub_labels_query_timed(hl, d, pred, source, target,
                                    preprocess_time, computation_time);
             stop = high_resolution_clock::now();
+          } else if (algo == 9) {
+            start = high_resolution_clock::now();
+            crp_query_timed(graph, ov, d, pred, source, target,
+                            preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
           } else {
             start = high_resolution_clock::now();
-            delta_stepping_timed(graph, d, pred, source, target, delta,
-                                 preprocess_time, computation_time);
+            dijkstra_compressed_timed(cg, d, pred, source, target,
+                                      preprocess_time, computation_time);
             stop = high_resolution_clock::now();
           }
+          cache_misses.push_back(cache_misses_stop(counter));
+          allocations.push_back({scratch.allocations - served,
+                                 scratch.system_allocations - system});
           duration = duration_cast<nanoseconds>(stop - start);
           times.push_back(duration.count());
           preprocess_times.push_back(preprocess_time);
@@ -159,6 +492,15 @@ int main(int argc, char **argv) {
         total_preprocess_time /= (double)num_repeat;
         total_computation_time /= (double)num_repeat;
 
+        if (!cycle.empty()) {
+          std::cout << '\n' << "Negative cycle:";
+          for (auto const &v : cycle)
+            std::cout << " " << rev_permutation[v];
+          std::cout << '\n' << std::endl;
+          file.close();
+          return 0;
+        }
+
         std::vector<int> p;
         path(pred, p, source, target);
 
@@ -173,6 +515,8 @@ int main(int argc, char **argv) {
         std::cout << '\n' << "Computation Times (in ns):";
         for (auto &t : computation_times)
           std::cout << std::fixed << ' ' << t;
+        print_cache_misses(cache_misses);
+        print_allocations(allocations);
 
         std::cout << std::fixed << '\n'
                   << "Average time: " << total_time << "ns" << '\n'
@@ -180,29 +524,107 @@ int main(int argc, char **argv) {
                   << "ns" << '\n'
                   << "Average computation time: " << total_computation_time
                   << "ns" << '\n'
+                  << "Prepare time: " << prepare_time << "ns" << '\n'
+                  << "Amortized time per query: "
+                  << total_time + (double)prepare_time / num_repeat << "ns"
+                  << '\n'
                   << "Path:";
         for (auto const &v : p)
-          std::cout << " " << v;
+          std::cout << " " << rev_permutation[v];
         std::cout << '\n' << "Length: " << d[target] << '\n' << std::endl;
       } else if (num == 2) {
-        algo = read_input(task_2_algo, {"1", "2"});
-        std::vector<std::vector<int>> d(n + 1,
-                                        std::vector<int>(b + 1, INT_MAX));
-        std::vector<std::vector<pii>> pred(n + 1, std::vector<pii>(b + 1));
+        algo = read_input(task_2_algo, {"1", "2", "3", "4", "5", "6"});
+        if (deadline_ms > 0 && (algo == 3 || algo == 6)) {
+          printf("Error: '--deadline' is not supported by the algorithms 3 "
+                 "and 6 of the task 2.\n");
+          return 1;
+        }
+        int interval = 0, length = INT_MAX, i = -1;
+        long long int memory = 0;
+        if (algo == 3)
+          interval = read_int(checkpoint_interval);
+        compressed_graph cg;
+        if (algo == 5 && !compress_and_report(graph, cg))
+          return 1;
+
+        // The full (n + 1) x (b + 1) tables are only needed by the algorithms
+        // 1, 2, 4 and 5, the checkpointed and bidirectional variants rebuild
+        // the path by themselves.
+        bool tables = algo != 3 && algo != 6;
+        std::vector<std::vector<int>> d;
+        std::vector<std::vector<pii>> pred;
+        std::vector<int> path;
+        if (tables) {
+          d.assign(n + 1, std::vector<int>(b + 1, INT_MAX));
+          pred.assign(n + 1, std::vector<pii>(b + 1));
+          memory = (long long int)(n + 1) * (b + 1) * (sizeof(int) + sizeof(pii));
+        }
+
+        // With a deadline, the algorithms 1, 2, 4 and 5 run their anytime
+        // variant (the other ones are rejected above).
+        bool anytime = deadline_ms > 0;
+        std::vector<anytime_result> reports;
 
         for (int _ = 0; _ < num_repeat; ++_) {
-          std::fill(d.begin(), d.end(), std::vector<int>(b + 1, INT_MAX));
-          std::fill(pred.begin(), pred.end(), std::vector<pii>(b + 1));
+          if (tables) {
+            std::fill(d.begin(), d.end(), std::vector<int>(b + 1, INT_MAX));
+            std::fill(pred.begin(), pred.end(), std::vector<pii>(b + 1));
+          }
 
-          if (algo == 1) {
+          counter = cache_misses_start();
+          if (anytime) {
+            query_deadline deadline(deadline_ms);
+            anytime_result report;
+            start = high_resolution_clock::now();
+            if (algo == 1)
+              dijkstra_constrained_anytime(graph, d, pred, source, target, b,
+                                           deadline, report);
+            else if (algo == 2)
+              bellman_ford_constrained_anytime(graph, d, pred, source, target,
+                                               b, deadline, report);
+            else if (algo == 4)
+              dijkstra_constrained_bucket_anytime(graph, d, pred, source,
+                                                  target, b, deadline, report);
+            else
+              dijkstra_constrained_compressed_anytime(
+                  cg, d, pred, source, target, b, deadline, report);
+            stop = high_resolution_clock::now();
+            preprocess_time = 0;
+            computation_time = duration_cast<nanoseconds>(stop - start).count();
+            reports.push_back(report);
+          } else if (algo == 1) {
             start = high_resolution_clock::now();
             dijkstra_constrained_timed(graph, d, pred, source, target, b, preprocess_time, computation_time);
             stop = high_resolution_clock::now();
-          } else {
+          } else if (algo == 2) {
             start = high_resolution_clock::now();
             bellman_ford_constrained_timed(graph, d, pred, source, target, b, preprocess_time, computation_time);
             stop = high_resolution_clock::now();
+          } else if (algo == 4) {
+            start = high_resolution_clock::now();
+            dijkstra_constrained_bucket_timed(graph, d, pred, source, target, b,
+                                              preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 5) {
+            start = high_resolution_clock::now();
+            dijkstra_constrained_compressed_timed(cg, d, pred, source, target, b,
+                                                  preprocess_time,
+                                                  computation_time);
+            stop = high_resolution_clock::now();
+          } else if (algo == 6) {
+            start = high_resolution_clock::now();
+            length = dijkstra_constrained_bidirectional_timed(
+                graph, path, i, source, target, b, memory, preprocess_time,
+                computation_time);
+            stop = high_resolution_clock::now();
+          } else {
+            start = high_resolution_clock::now();
+            length = bellman_ford_constrained_checkpointed_timed(
+                graph, path, i, source, target, b, interval, memory,
+                preprocess_time, computation_time);
+            stop = high_resolution_clock::now();
           }
+          cache_misses.push_back(cache_misses_stop(counter));
           duration = duration_cast<nanoseconds>(stop - start);
           times.push_back(duration.count());
           preprocess_times.push_back(preprocess_time);
@@ -216,11 +638,15 @@ int main(int argc, char **argv) {
         total_preprocess_time /= (double)num_repeat;
         total_computation_time /= (double)num_repeat;
 
-        int i;
-        for (i = 0; pred[target][i].first == 0; ++i)
-          ;
-        std::vector<int> path;
-        path_delay(pred, path, source, target, i);
+        if (tables) {
+          for (i = 0; i <= b && pred[target][i].first == 0; ++i)
+            ;
+          if (i <= b) {
+            path_delay(pred, path, source, target, i);
+            length = d[target][i];
+          } else
+            i = -1;
+        }
 
         std::cout << '\n' << "Times (in ns):";
         for (auto &t : times)
@@ -233,6 +659,9 @@ int main(int argc, char **argv) {
         std::cout << '\n' << "Computation Times (in ns):";
         for (auto &t : computation_times)
           std::cout << std::fixed << ' ' << t;
+        print_cache_misses(cache_misses);
+        if (anytime)
+          print_anytime(reports);
 
         std::cout << std::fixed << '\n'
                   << "Average time: " << total_time << "ns" << '\n'
@@ -240,23 +669,41 @@ int main(int argc, char **argv) {
                   << "ns" << '\n'
                   << "Average computation time: " << total_computation_time
                   << "ns" << '\n'
-                  << "Path:";
+                  << "Memory (in bytes): " << memory << '\n';
+        if (anytime)
+          std::cout << "Optimal: " << (reports.back().optimal ? "yes" : "no")
+                    << '\n'
+                    << "Lower bound (delay, length): ("
+                    << reports.back().delay_bound << ", "
+                    << reports.back().length_bound << ")" << '\n';
+        std::cout << "Path:";
         for (auto const &v : path)
-          std::cout << " " << v;
+          std::cout << " " << rev_permutation[v];
         std::cout << '\n'
-                  << "Length: " << d[target][i] << '\n'
+                  << "Length: " << length << '\n'
                   << "Delay: " << i << '\n'
                   << std::endl;
       } else if (num == 3) {
         int k = read_int(task_3_k);
 
         std::vector<std::vector<int>> paths;
+        std::vector<anytime_result> reports;
         for (int _ = 0; _ < num_repeat; ++_) {
           paths.clear();
 
+          served = scratch.allocations;
+          system = scratch.system_allocations;
           start = high_resolution_clock::now();
-          paths = dijkstra_k_shortest_paths(graph, source, k);
+          if (deadline_ms > 0) {
+            query_deadline deadline(deadline_ms);
+            reports.emplace_back();
+            paths = dijkstra_k_shortest_paths_anytime(graph, source, k,
+                                                      deadline, reports.back());
+          } else
+            paths = dijkstra_k_shortest_paths(graph, source, k);
           stop = high_resolution_clock::now();
+          allocations.push_back({scratch.allocations - served,
+                                 scratch.system_allocations - system});
           duration = duration_cast<nanoseconds>(stop - start);
           times.push_back(duration.count());
           total_time += (double)duration.count();
@@ -267,11 +714,20 @@ int main(int argc, char **argv) {
         std::cout << '\n' << "Times (in ns):";
         for (auto &t : times)
           std::cout << std::fixed << ' ' << t;
+        print_allocations(allocations);
+        if (deadline_ms > 0) {
+          print_anytime(reports);
+          std::cout << '\n'
+                    << "Optimal: " << (reports.back().optimal ? "yes" : "no")
+                    << '\n'
+                    << "Lower bound (length of the next paths): "
+                    << reports.back().length_bound;
+        }
         std::cout << std::fixed << '\n' << "Average time: " << total_time << "ns" << '\n';
         for (auto const &p : paths) {
           std::cout << '\n' << "Path:";
           for (size_t i = 1; i < p.size(); ++i)
-            std::cout << " " << p[i];
+            std::cout << " " << rev_permutation[p[i]];
           std::cout << '\n' << "Length: " << p[0] << '\n' << std::endl;
         }
       }
@@ -0,0 +1,186 @@
+#include "tasks.hpp"
+#include <chrono>
+#include <sstream>
+using namespace std::chrono;
+
+/* Farthest vertex (in hops, on the undirected graph) from 'root' by BFS; its
+ * eccentricity is stored in 'hops'.
+ */
+static int farthest(std::vector<std::vector<int>> &adj, int root, int &hops) {
+  std::vector<int> dist(adj.size(), -1);
+  std::queue<int> queue;
+  dist[root] = 0;
+  queue.push(root);
+  int u = root;
+  while (!queue.empty()) {
+    u = queue.front();
+    queue.pop();
+    for (auto const &v : adj[u]) {
+      if (dist[v] < 0) {
+        dist[v] = dist[u] + 1;
+        queue.push(v);
+      }
+    }
+  }
+  hops = dist[u];
+  return u;
+}
+
+/* Compute the profile of the graph: weights (range, sign), out-degrees
+ * (average, 99th percentile and maximum), zero-delay edges and an estimate of
+ * the diameter in hops by a double sweep (a BFS from the farthest vertex of a
+ * first BFS, a lower bound which is usually tight).
+ */
+void profile_graph(std::vector<std::vector<tii>> &graph,
+                   graph_profile &profile) {
+  int n = graph.size() - 1;
+  profile = {};
+  profile.n = n;
+  profile.min_weight = INT_MAX;
+  profile.max_weight = INT_MIN;
+  long long int total = 0;
+  std::vector<int> degrees(n);
+  std::vector<std::vector<int>> adj(n + 1);
+  for (int u = 1; u <= n; ++u) {
+    degrees[u - 1] = graph[u].size();
+    for (auto const &[w, z, v] : graph[u]) {
+      profile.min_weight = std::min(profile.min_weight, w);
+      profile.max_weight = std::max(profile.max_weight, w);
+      total += w;
+      profile.negative_edges += w < 0;
+      profile.zero_delay_edges += z == 0;
+      adj[u].push_back(v);
+      adj[v].push_back(u);
+    }
+    profile.m += graph[u].size();
+  }
+  if (profile.m == 0)
+    profile.min_weight = profile.max_weight = 0;
+  profile.average_weight = profile.m ? (double)total / profile.m : 0.0;
+  profile.average_degree = n ? (double)profile.m / n : 0.0;
+
+  std::sort(degrees.begin(), degrees.end());
+  if (n) {
+    profile.max_degree = degrees.back();
+    profile.degree_p99 = degrees[std::min(n - 1, (int)(0.99 * n))];
+    int hops, far = farthest(adj, 1, hops);
+    farthest(adj, far, profile.diameter);
+  }
+}
+
+/* Run 'query' on the sample queries and return the total time (in ns).
+ */
+static long long int
+calibrate(std::vector<pii> &samples, int n,
+          std::function<void(std::vector<int> &, std::vector<int> &, int, int)>
+              query) {
+  std::vector<int> d(n + 1), pred(n + 1);
+  long long int total = 0;
+  for (auto const &[source, target] : samples) {
+    std::fill(d.begin(), d.end(), INT_MAX);
+    std::fill(pred.begin(), pred.end(), 0);
+    auto start = high_resolution_clock::now();
+    query(d, pred, source, target);
+    auto stop = high_resolution_clock::now();
+    total += duration_cast<nanoseconds>(stop - start).count();
+  }
+  return total;
+}
+
+/* Choose a task 1 engine (with the numbering of the prompts of 'main.cpp')
+ * for the queries from 'source', from the profile and a calibration run on a
+ * few queries (the first one from 'source', the other ones random):
+ *   - with negative weights, only the label-correcting engines are exact: the
+ * Bellman-Ford with subtree disassembly (6) when the graph has a negative cycle
+ * (searched from a virtual source linked to every vertex, so that it's found
+ * wherever it is; the engine reports it when it's reachable), otherwise the
+ * fastest of it and Yen's variant (4), which can then run from any source.
+ *   - otherwise, Dijkstra (1) against the Δ-stepping (5) with a few values of
+ * Δ around the classical choice max weight / average degree (a bucket then
+ * holds about one edge weight of the neighbourhood of a vertex).
+ * The naive Bellman-Ford (3) and the parallel Dijkstra (2) are never better.
+ * Δ is stored in 'delta' and the decision (with the calibration times) is
+ * written in 'log'.
+ */
+int auto_select_engine(std::vector<std::vector<tii>> &graph,
+                       graph_profile &profile, int source, int &delta,
+                       std::string &log) {
+  const int SAMPLES = 3;
+  int n = profile.n;
+  std::ostringstream out;
+  out << "Profile: n=" << n << " m=" << profile.m << " weights=["
+      << profile.min_weight << ", " << profile.max_weight
+      << "] average weight=" << profile.average_weight
+      << " negative edges=" << profile.negative_edges
+      << " zero-delay edges=" << profile.zero_delay_edges
+      << " degree (average/p99/max)=" << profile.average_degree << '/'
+      << profile.degree_p99 << '/' << profile.max_degree
+      << " diameter (hops)>=" << profile.diameter << '\n';
+
+  std::mt19937 generator(n);
+  std::uniform_int_distribution<int> vertex(1, std::max(n, 1));
+  std::vector<pii> samples;
+  for (int i = 0; i < SAMPLES; ++i) {
+    int s = vertex(generator);
+    samples.push_back({i == 0 && source > 0 ? source : s, vertex(generator)});
+  }
+
+  std::vector<std::pair<int, int>> candidates; // (algorithm, Δ)
+  if (profile.negative_edges) {
+    std::vector<int> h, cycle;
+    if (!johnson_potentials(graph, h, cycle)) {
+      delta = 0;
+      out << "Decision: algorithm 6 (the graph has a negative cycle, it will be "
+             "reported if it's reachable)";
+      log = out.str();
+      return 6;
+    }
+    candidates = {{4, 0}, {6, 0}};
+  } else {
+    candidates = {{1, 0}};
+    int base = std::max(1, (int)(profile.max_weight /
+                                 std::max(1.0, profile.average_degree)));
+    for (int value : {base / 4, base, 4 * base}) {
+      if (value >= 1)
+        candidates.push_back({5, value});
+    }
+  }
+
+  int best = 0;
+  long long int best_time = LLONG_MAX;
+  out << "Calibration (" << SAMPLES << " queries):";
+  for (auto const &[algo, value] : candidates) {
+    int delta_value = value;
+    long long int time = calibrate(
+        samples, n,
+        [&graph, algo = algo, delta_value](std::vector<int> &d,
+                                           std::vector<int> &pred, int s,
+                                           int t) {
+          std::vector<int> cycle;
+          if (algo == 1)
+            dijkstra(graph, d, pred, s, t);
+          else if (algo == 4)
+            bellman_ford_yen(graph, d, pred, s, t);
+          else if (algo == 5)
+            delta_stepping(graph, d, pred, s, t, delta_value);
+          else
+            bellman_ford_tarjan(graph, d, pred, s, t, cycle);
+        });
+    out << " algorithm " << algo;
+    if (algo == 5)
+      out << " (delta=" << value << ")";
+    out << ": " << time << "ns;";
+    if (time < best_time) {
+      best_time = time;
+      best = algo;
+      delta = value;
+    }
+  }
+  out << '\n' << "Decision: algorithm " << best;
+  if (best == 5)
+    out << " with delta=" << delta;
+  out << (profile.negative_edges ? " (negative weights)"
+                                 : " (non-negative weights)");
+  log = out.str();
+  return best;
+}
@@ -0,0 +1,187 @@
+#include "tasks.hpp"
+#include <numeric>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Build the undirected adjacency (without weights) of the input graph, it's
+ * used by the bandwidth-reducing orderings below which ignore edge directions.
+ */
+static void undirected_adjacency(std::vector<std::vector<tii>> &graph,
+                                 std::vector<std::vector<int>> &adj) {
+  int n = graph.size() - 1;
+  adj.assign(n + 1, {});
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u]) {
+      adj[u].push_back(v);
+      adj[v].push_back(u);
+    }
+  }
+}
+
+/* Breadth-first numbering of every connected component, each one is started
+ * from its vertex of minimum degree (a cheap pseudo-peripheral vertex) and the
+ * neighbours are visited by increasing degree when 'by_degree' is set, which is
+ * the Cuthill-McKee ordering.
+ */
+static void bfs_order(std::vector<std::vector<int>> &adj,
+                      std::vector<int> &order, bool by_degree) {
+  int n = adj.size() - 1;
+  std::vector<int> seeds(n);
+  std::iota(seeds.begin(), seeds.end(), 1);
+  std::stable_sort(seeds.begin(), seeds.end(), [&adj](int a, int b) {
+    return adj[a].size() < adj[b].size();
+  });
+
+  if (by_degree) {
+    for (int u = 1; u <= n; ++u)
+      std::sort(adj[u].begin(), adj[u].end(), [&adj](int a, int b) {
+        return adj[a].size() < adj[b].size() ||
+               (adj[a].size() == adj[b].size() && a < b);
+      });
+  }
+
+  std::vector<bool> visited(n + 1);
+  order.clear();
+  for (auto const &s : seeds) {
+    if (visited[s])
+      continue;
+    visited[s] = true;
+    size_t head = order.size();
+    order.push_back(s);
+    while (head < order.size()) {
+      int u = order[head++];
+      for (auto const &v : adj[u]) {
+        if (!visited[v]) {
+          visited[v] = true;
+          order.push_back(v);
+        }
+      }
+    }
+  }
+}
+
+/* Compute a relabelling of the vertices meant to improve the memory locality
+ * of the engines: 'permutation[u]' is the new label of the vertex u and
+ * 'rev_permutation' is its inverse. The available methods are:
+ *   - "rcm": reverse Cuthill-McKee, see E. Cuthill and J. McKee, "Reducing the
+ * bandwidth of sparse symmetric matrices", Proceedings of the 1969 24th
+ * national conference.
+ *   - "bfs": plain breadth-first order.
+ *   - "degree": hub-first order i.e. by decreasing (in + out) degree.
+ * Return 'false' if the method is unknown.
+ */
+bool reorder_permutation(std::vector<std::vector<tii>> &graph,
+                         std::string const &method,
+                         std::vector<int> &permutation,
+                         std::vector<int> &rev_permutation) {
+  int n = graph.size() - 1;
+  std::vector<std::vector<int>> adj;
+  undirected_adjacency(graph, adj);
+
+  std::vector<int> order;
+  if (method == "rcm") {
+    bfs_order(adj, order, true);
+    std::reverse(order.begin(), order.end());
+  } else if (method == "bfs")
+    bfs_order(adj, order, false);
+  else if (method == "degree") {
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 1);
+    std::stable_sort(order.begin(), order.end(), [&adj](int a, int b) {
+      return adj[a].size() > adj[b].size();
+    });
+  } else
+    return false;
+
+  permutation.assign(n + 1, 0);
+  rev_permutation.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    permutation[order[i]] = i + 1;
+    rev_permutation[i + 1] = order[i];
+  }
+  return true;
+}
+
+/* Relabel the vertices (and edges) of the graph using 'permutation'. The
+ * adjacency lists are sorted by target so that the neighbours of a vertex are
+ * read in increasing memory order.
+ */
+void reorder_graph(std::vector<std::vector<tii>> &graph,
+                   std::vector<int> &permutation) {
+  int n = graph.size() - 1;
+  std::vector<std::vector<tii>> reordered(n + 1);
+  for (int u = 1; u <= n; ++u) {
+    auto &edges = reordered[permutation[u]];
+    edges.reserve(graph[u].size());
+    for (auto const &[w, z, v] : graph[u])
+      edges.push_back({w, z, permutation[v]});
+    std::sort(edges.begin(), edges.end(), [](tii const &a, tii const &b) {
+      return std::get<2>(a) < std::get<2>(b);
+    });
+  }
+  graph.swap(reordered);
+}
+
+/* A locality measure of the labelling: the average distance |u - v| between
+ * the endpoints of the edges (the bandwidth is returned in 'bandwidth').
+ */
+double average_edge_span(std::vector<std::vector<tii>> &graph,
+                         int &bandwidth) {
+  int n = graph.size() - 1;
+  long long int total = 0, m = 0;
+  bandwidth = 0;
+  for (int u = 1; u <= n; ++u) {
+    for (auto const &[w, z, v] : graph[u]) {
+      total += std::abs(u - v);
+      bandwidth = std::max(bandwidth, std::abs(u - v));
+      ++m;
+    }
+  }
+  return m ? (double)total / (double)m : 0.0;
+}
+
+/* Hardware cache-miss counter (Linux perf events). 'cache_misses_start'
+ * returns a file descriptor or -1 when the counter is not available (e.g.
+ * non-Linux systems or restricted 'perf_event_paranoid' settings), in which
+ * case 'cache_misses_stop' returns -1 too.
+ */
+int cache_misses_start() {
+#ifdef __linux__
+  struct perf_event_attr attr = {};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+long long int cache_misses_stop(int fd) {
+#ifdef __linux__
+  if (fd < 0)
+    return -1;
+  long long int count = -1;
+  ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  if (read(fd, &count, sizeof(count)) != sizeof(count))
+    count = -1;
+  close(fd);
+  return count;
+#else
+  return -1;
+#endif
+}
@@ -0,0 +1,631 @@
+#include "tasks.hpp"
+#include "compressed.hpp"
+#include "deadline.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std::chrono;
+
+/*
+  A long-running query server: the graph is loaded once and the queries are
+  read line by line from a Unix domain socket, one response line per query.
+
+  Protocol (vertices use the labels of the input file):
+    1 [algo] [source] [target] [delta]  ->  OK [length] [path]
+    2 [algo] [source] [target]          ->  OK [length] [delay] [path]
+    3 [source] [k]                      ->  OK [length] [path] | [length] ...
+    stats                               ->  OK requests=... p50=...ns ...
+    quit                                ->  closes the connection
+    shutdown                            ->  stops the server
+  The algorithms are numbered as in the prompts of 'main.cpp' (the delta is
+  only read for the Δ-stepping, the customizable route planning uses cells of
+  'CRP_CELL_SIZE' vertices on 'CRP_LEVELS' levels). Errors are answered by
+  'ERROR [message]'.
+
+  The long task 2 (algorithms 1, 2, 4 and 5) and task 3 queries are cancelled
+  by the shutdown and answered by 'ERROR cancelled'.
+
+  With an index file, the plans of the task 1 algorithms 4 and 5 are mapped
+  from it on their first query, and the missing ones are added to it once
+  built, so that the next server processes start with them.
+
+  The queries are executed by a pool of workers. Pending task 1 queries sharing
+  the same source (and algorithm) are coalesced into one full traversal, except
+  for the hub labels and the customizable route planning which only answer
+  point-to-point queries.
+*/
+
+static const int CRP_CELL_SIZE = 64, CRP_LEVELS = 2;
+
+// At most this number of Δ-stepping plans are kept (the least recently used
+// one is evicted), each of them holding a copy of the edges.
+static const size_t MAX_DELTA_PLANS = 4;
+
+struct request {
+  int task, algo, source, target, extra;
+  high_resolution_clock::time_point arrival;
+  std::promise<std::string> response;
+};
+
+/* Latency histogram with log-linear buckets: 16 sub-buckets per power of two,
+ * i.e. a relative error below 1/16 on the reported percentiles.
+ */
+static const int SUB_BUCKETS = 16;
+
+static int histogram_bucket(long long int ns) {
+  if (ns < SUB_BUCKETS)
+    return (int)std::max(ns, 0LL);
+  int e = 63 - __builtin_clzll(ns);
+  return (e - 3) * SUB_BUCKETS + (int)((ns >> (e - 4)) & (SUB_BUCKETS - 1));
+}
+
+static long long int histogram_value(int bucket) {
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+  int e = bucket / SUB_BUCKETS + 3;
+  return (long long int)(SUB_BUCKETS + bucket % SUB_BUCKETS + 1) << (e - 4);
+}
+
+struct server_state {
+  std::vector<std::vector<tii>> &graph;
+  int b;
+  std::vector<int> &permutation, &rev_permutation;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::shared_ptr<request>> jobs;
+  std::atomic<bool> stop{false};
+  int listener = -1;
+
+  // Open connections (closed by their own thread or at the shutdown).
+  std::mutex connections_mutex;
+  std::condition_variable connections_cv;
+  std::set<int> connections;
+
+  // Johnson potentials, computed on the first query which needs them.
+  std::once_flag johnson_flag;
+  std::vector<int> h, cycle;
+  std::vector<std::vector<tii>> reweighted;
+
+  // Prepared engines (see 'prepare_yen'), built on the first query which
+  // needs them and shared by the workers: one plan per Δ for the Δ-stepping
+  // (with the time of its last use).
+  std::once_flag yen_flag;
+  yen_plan yen;
+  // Index file of the plans (see 'index.cpp'): each save renames a new file
+  // which is then mapped, the previous mappings are kept until the end since
+  // the plans mapped from them may still be used.
+  std::string index_file;
+  unsigned long long hash = 0;
+  bool verify_index = false;
+  std::mutex index_mutex;
+  std::deque<plan_index> indexes;
+  std::mutex delta_mutex;
+  std::map<int, std::pair<std::shared_ptr<delta_plan>, long long int>>
+      delta_plans;
+  long long int delta_uses = 0;
+
+  // Hub labels ('labels_ok' is false with negative weights), overlay of the
+  // customizable route planning and compressed adjacency, also built on the
+  // first query which needs them.
+  std::once_flag labels_flag, overlay_flag, compressed_flag;
+  hub_labels labels;
+  bool labels_ok = false, overlay_ok = false, compressed_ok = false;
+  crp_overlay overlay;
+  compressed_graph compressed;
+
+  std::mutex stats_mutex;
+  std::vector<long long int> histogram = std::vector<long long int>(64 * SUB_BUCKETS);
+  long long int requests = 0, coalesced = 0;
+  high_resolution_clock::time_point start = high_resolution_clock::now();
+
+  server_state(std::vector<std::vector<tii>> &graph, int b,
+               std::vector<int> &permutation, std::vector<int> &rev_permutation)
+      : graph(graph), b(b), permutation(permutation),
+        rev_permutation(rev_permutation) {}
+};
+
+static void record_latency(server_state &state, request &r) {
+  long long int ns =
+      duration_cast<nanoseconds>(high_resolution_clock::now() - r.arrival)
+          .count();
+  std::lock_guard<std::mutex> lock(state.stats_mutex);
+  ++state.histogram[histogram_bucket(ns)];
+  ++state.requests;
+}
+
+static std::string stats(server_state &state) {
+  std::lock_guard<std::mutex> lock(state.stats_mutex);
+  double uptime =
+      duration_cast<nanoseconds>(high_resolution_clock::now() - state.start)
+          .count() /
+      1e9;
+  std::ostringstream out;
+  out << "OK requests=" << state.requests << " coalesced=" << state.coalesced
+      << " uptime=" << uptime << "s throughput=" << state.requests / uptime
+      << "/s";
+  for (auto const &[name, q] : {std::pair<const char *, double>{"p50", 0.5},
+                                {"p99", 0.99},
+                                {"p999", 0.999}}) {
+    long long int rank = (long long int)(q * state.requests), seen = 0;
+    int i = 0;
+    if (state.requests) {
+      for (; i < (int)state.histogram.size() - 1; ++i) {
+        seen += state.histogram[i];
+        if (seen > rank)
+          break;
+      }
+    }
+    out << ' ' << name << '=' << histogram_value(i) << "ns";
+  }
+  return out.str();
+}
+
+/* Add the plan built in memory to the index file and map the new file ('yen'
+ * or 'delta' is null), under 'index_mutex'.
+ */
+static void store_plan(server_state &state, yen_plan *yen, delta_plan *delta) {
+  int n = state.graph.size() - 1;
+  if (!save_index(state.indexes.back(), state.index_file, state.hash, n, yen,
+                  delta)) {
+    printf("Error: cannot write the index file: %s\n",
+           state.index_file.c_str());
+    return;
+  }
+  state.indexes.emplace_back();
+  if (!open_index(state.indexes.back(), state.index_file, state.hash, n))
+    state.indexes.pop_back();
+}
+
+/* Yen's plan, mapped from the index file if it has it, otherwise built (and
+ * added to it).
+ */
+static void yen_plan_ready(server_state &state) {
+  std::call_once(state.yen_flag, [&state] {
+    int n = state.graph.size() - 1;
+    if (!state.index_file.empty()) {
+      std::lock_guard<std::mutex> lock(state.index_mutex);
+      if (index_yen_plan(state.indexes.back(), n, state.yen,
+                         state.verify_index))
+        return;
+    }
+    prepare_yen(state.graph, state.yen);
+    if (!state.index_file.empty()) {
+      std::lock_guard<std::mutex> lock(state.index_mutex);
+      store_plan(state, &state.yen, nullptr);
+    }
+  });
+}
+
+/* The Δ-stepping plan of 'delta', prepared the first time it's asked for
+ * (mapped from the index file if it has it, otherwise built and added to it).
+ * The least recently used plan is evicted beyond 'MAX_DELTA_PLANS' (the
+ * queries still running on it keep it alive).
+ */
+static std::shared_ptr<delta_plan> delta_plan_for(server_state &state,
+                                                  int delta) {
+  std::lock_guard<std::mutex> lock(state.delta_mutex);
+  auto it = state.delta_plans.find(delta);
+  if (it == state.delta_plans.end()) {
+    if (state.delta_plans.size() >= MAX_DELTA_PLANS)
+      state.delta_plans.erase(std::min_element(
+          state.delta_plans.begin(), state.delta_plans.end(),
+          [](auto const &a, auto const &b) {
+            return a.second.second < b.second.second;
+          }));
+    auto plan = std::make_shared<delta_plan>();
+    int n = state.graph.size() - 1;
+    bool mapped = false;
+    if (!state.index_file.empty()) {
+      std::lock_guard<std::mutex> index_lock(state.index_mutex);
+      mapped = index_delta_plan(state.indexes.back(), n, delta, *plan,
+                                state.verify_index);
+    }
+    if (!mapped) {
+      prepare_delta_stepping(state.graph, delta, *plan);
+      if (!state.index_file.empty()) {
+        std::lock_guard<std::mutex> index_lock(state.index_mutex);
+        store_plan(state, nullptr, plan.get());
+      }
+    }
+    it = state.delta_plans.insert({delta, {plan, 0}}).first;
+  }
+  it->second.second = ++state.delta_uses;
+  return it->second.first;
+}
+
+/* Compress the graph the first time it's needed, 'false' is returned if it
+ * doesn't fit the encoding.
+ */
+static bool compressed_ready(server_state &state) {
+  std::call_once(state.compressed_flag, [&state] {
+    state.compressed_ok = compress_graph(state.graph, state.compressed, false);
+  });
+  return state.compressed_ok;
+}
+
+static void append_path(std::ostringstream &out, server_state &state,
+                        std::vector<int> &p) {
+  for (auto const &v : p)
+    out << ' ' << state.rev_permutation[v];
+}
+
+/* Answer a batch of task 1 queries sharing the same source and algorithm.
+ */
+static void run_task_1(server_state &state,
+                       std::vector<std::shared_ptr<request>> &batch) {
+  request &r = *batch[0];
+  int n = state.graph.size() - 1;
+  // A coalesced batch needs the whole shortest path tree: the target 0 is
+  // never reached, so there is no early exit.
+  int target = batch.size() > 1 ? 0 : r.target;
+  std::vector<int> d(n + 1, INT_MAX), pred(n + 1), cycle;
+  std::string error;
+
+  if (r.algo == 1)
+    dijkstra(state.graph, d, pred, r.source, target);
+  else if (r.algo == 2)
+    dijkstra_parallel(state.graph, d, pred, r.source, target);
+  else if (r.algo == 3)
+    bellman_ford(state.graph, d, pred, r.source, target);
+  else if (r.algo == 4) {
+    yen_plan_ready(state);
+    bellman_ford_yen_prepared(state.yen, d, pred, r.source, target);
+  } else if (r.algo == 5)
+    delta_stepping_prepared(*delta_plan_for(state, r.extra), d, pred, r.source,
+                            target);
+  else if (r.algo == 6)
+    bellman_ford_tarjan(state.graph, d, pred, r.source, target, cycle);
+  else if (r.algo == 7) {
+    std::call_once(state.johnson_flag, [&state] {
+      if (johnson_potentials(state.graph, state.h, state.cycle))
+        johnson_reweight(state.graph, state.h, state.reweighted);
+    });
+    if (state.cycle.empty())
+      dijkstra_johnson(state.reweighted, state.h, d, pred, r.source, target);
+    else
+      cycle = state.cycle;
+  } else if (r.algo == 8) {
+    std::call_once(state.labels_flag, [&state] {
+      state.labels_ok = build_hub_labels(state.graph, state.labels);
+    });
+    if (!state.labels_ok)
+      error = "hub labels need non-negative weights";
+    else
+      hub_labels_query(state.labels, d, pred, r.source, r.target);
+  } else if (r.algo == 9) {
+    std::call_once(state.overlay_flag, [&state] {
+      crp_partition(state.graph, state.overlay, CRP_CELL_SIZE, CRP_LEVELS);
+      state.overlay_ok = crp_customize(state.graph, state.overlay);
+    });
+    if (!state.overlay_ok)
+      error = "the overlay needs non-negative weights";
+    else
+      crp_query(state.graph, state.overlay, d, pred, r.source, r.target);
+  } else if (r.algo == 10) {
+    if (!compressed_ready(state))
+      error = "the weights don't fit the compressed encoding";
+    else
+      dijkstra_compressed(state.compressed, d, pred, r.source, target);
+  }
+
+  for (auto &q : batch) {
+    std::ostringstream out;
+    if (!error.empty())
+      out << "ERROR " << error;
+    else if (!cycle.empty()) {
+      out << "ERROR negative cycle:";
+      append_path(out, state, cycle);
+    } else if (d[q->target] == INT_MAX)
+      out << "ERROR unreachable target";
+    else {
+      std::vector<int> p;
+      path(pred, p, q->source, q->target);
+      out << "OK " << d[q->target];
+      append_path(out, state, p);
+    }
+    record_latency(state, *q);
+    q->response.set_value(out.str());
+  }
+}
+
+static void run_task_2(server_state &state, request &r) {
+  int n = state.graph.size() - 1, b = state.b, delay = -1, length = INT_MAX;
+  std::vector<int> p;
+  std::string error;
+  query_deadline deadline(0, &state.stop);
+  anytime_result report;
+  report.optimal = true;
+  if (r.source == r.target) {
+    delay = length = 0;
+    p.push_back(r.source);
+  } else if (r.algo == 3) {
+    long long int memory;
+    length = bellman_ford_constrained_checkpointed(
+        state.graph, p, delay, r.source, r.target, b,
+        std::max(1, (int)std::sqrt(b + 1)), memory);
+  } else if (r.algo == 6) {
+    long long int memory;
+    length = dijkstra_constrained_bidirectional(state.graph, p, delay,
+                                                r.source, r.target, b, memory);
+  } else if (r.algo == 5 && !compressed_ready(state))
+    error = "the weights don't fit the compressed encoding";
+  else {
+    std::vector<std::vector<int>> d(n + 1, std::vector<int>(b + 1, INT_MAX));
+    std::vector<std::vector<pii>> pred(n + 1, std::vector<pii>(b + 1));
+    if (r.algo == 1)
+      dijkstra_constrained_anytime(state.graph, d, pred, r.source, r.target, b,
+                                   deadline, report);
+    else if (r.algo == 2)
+      bellman_ford_constrained_anytime(state.graph, d, pred, r.source,
+                                       r.target, b, deadline, report);
+    else if (r.algo == 4)
+      dijkstra_constrained_bucket_anytime(state.graph, d, pred, r.source,
+                                          r.target, b, deadline, report);
+    else
+      dijkstra_constrained_compressed_anytime(state.compressed, d, pred,
+                                              r.source, r.target, b, deadline,
+                                              report);
+    for (int i = 0; i <= b && delay < 0; ++i) {
+      if (pred[r.target][i].first != 0)
+        delay = i;
+    }
+    if (delay >= 0) {
+      path_delay(pred, p, r.source, r.target, delay);
+      length = d[r.target][delay];
+    }
+  }
+
+  std::ostringstream out;
+  if (!error.empty())
+    out << "ERROR " << error;
+  else if (!report.optimal)
+    out << "ERROR cancelled";
+  else if (delay < 0)
+    out << "ERROR unreachable target within the delay bound";
+  else {
+    out << "OK " << length << ' ' << delay;
+    append_path(out, state, p);
+  }
+  record_latency(state, r);
+  r.response.set_value(out.str());
+}
+
+static void run_task_3(server_state &state, request &r) {
+  query_deadline deadline(0, &state.stop);
+  anytime_result report;
+  auto paths = dijkstra_k_shortest_paths_anytime(state.graph, r.source,
+                                                 r.extra, deadline, report);
+  std::ostringstream out;
+  if (!report.optimal)
+    paths.clear();
+  out << (report.optimal ? "OK" : "ERROR cancelled");
+  for (size_t i = 0; i < paths.size(); ++i) {
+    out << (i ? " | " : " ") << paths[i][0];
+    for (size_t j = 1; j < paths[i].size(); ++j)
+      out << ' ' << state.rev_permutation[paths[i][j]];
+  }
+  record_latency(state, r);
+  r.response.set_value(out.str());
+}
+
+static void worker(server_state &state) {
+  while (true) {
+    std::vector<std::shared_ptr<request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.cv.wait(lock,
+                    [&state] { return state.stop || !state.jobs.empty(); });
+      if (state.jobs.empty())
+        return;
+      batch.push_back(state.jobs.front());
+      state.jobs.pop_front();
+
+      // Coalesce the pending task 1 queries from the same source.
+      request &r = *batch[0];
+      if (r.task == 1) {
+        for (auto it = state.jobs.begin(); it != state.jobs.end();) {
+          request &q = **it;
+          if (q.task == 1 && q.algo == r.algo && q.source == r.source &&
+              q.extra == r.extra && r.algo != 8 && r.algo != 9) {
+            batch.push_back(*it);
+            it = state.jobs.erase(it);
+          } else
+            ++it;
+        }
+      }
+    }
+    if (batch.size() > 1) {
+      std::lock_guard<std::mutex> lock(state.stats_mutex);
+      state.coalesced += batch.size();
+    }
+
+    request &r = *batch[0];
+    if (r.task == 1)
+      run_task_1(state, batch);
+    else if (r.task == 2)
+      run_task_2(state, r);
+    else
+      run_task_3(state, r);
+  }
+}
+
+/* Parse a query line, return an empty string if it's valid (an error message
+ * otherwise). The vertices are translated to the internal labels.
+ */
+static std::string parse_request(server_state &state, std::string &line,
+                                 request &r) {
+  std::istringstream in(line);
+  int n = state.graph.size() - 1;
+  r.extra = 0;
+  r.algo = 0;
+  r.target = 1;
+  if (!(in >> r.task) || r.task < 1 || r.task > 3)
+    return "unknown command";
+  if (r.task == 3) {
+    if (!(in >> r.source >> r.extra) || r.extra <= 0)
+      return "usage: 3 [source] [k]";
+  } else {
+    if (!(in >> r.algo >> r.source >> r.target))
+      return "usage: " + std::to_string(r.task) + " [algo] [source] [target]";
+    if (r.algo < 1 || r.algo > (r.task == 1 ? 10 : 6))
+      return "unknown algorithm";
+    if (r.task == 1 && r.algo == 5 && (!(in >> r.extra) || r.extra <= 0))
+      return "usage: 1 5 [source] [target] [delta]";
+  }
+  if (r.source < 1 || r.source > n || r.target < 1 || r.target > n)
+    return "vertices must be between 1 and " + std::to_string(n);
+  r.source = state.permutation[r.source];
+  r.target = state.permutation[r.target];
+  return "";
+}
+
+static bool send_line(int fd, std::string s) {
+  s.push_back('\n');
+  for (size_t sent = 0; sent < s.size();) {
+    ssize_t k = send(fd, s.data() + sent, s.size() - sent, MSG_NOSIGNAL);
+    if (k <= 0)
+      return false;
+    sent += k;
+  }
+  return true;
+}
+
+static void connection(server_state &state, int fd) {
+  std::string buffer, line;
+  char chunk[4096];
+  ssize_t k;
+  bool open = true;
+  while (open && (k = recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+    buffer.append(chunk, k);
+    size_t eol;
+    while (open && (eol = buffer.find('\n')) != std::string::npos) {
+      line = buffer.substr(0, eol);
+      buffer.erase(0, eol + 1);
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (line.empty())
+        continue;
+
+      if (line == "quit")
+        open = false;
+      else if (line == "stats")
+        open = send_line(fd, stats(state));
+      else if (line == "shutdown") {
+        send_line(fd, "OK");
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          state.stop = true;
+        }
+        state.cv.notify_all();
+        ::shutdown(state.listener, SHUT_RDWR);
+        open = false;
+      } else {
+        auto r = std::make_shared<request>();
+        r->arrival = high_resolution_clock::now();
+        std::string error = parse_request(state, line, *r);
+        if (!error.empty()) {
+          open = send_line(fd, "ERROR " + error);
+          continue;
+        }
+        auto response = r->response.get_future();
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          if (state.stop) {
+            open = false;
+            break;
+          }
+          state.jobs.push_back(r);
+        }
+        state.cv.notify_one();
+        open = send_line(fd, response.get());
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(state.connections_mutex);
+  state.connections.erase(fd);
+  close(fd);
+  state.connections_cv.notify_all();
+}
+
+/* Serve the queries on the Unix domain socket 'socket_path' with 'workers'
+ * threads until a 'shutdown' command is received. Return 0 on success.
+ */
+int run_server(std::vector<std::vector<tii>> &graph, int b,
+               std::string const &socket_path, int workers,
+               std::vector<int> &permutation,
+               std::vector<int> &rev_permutation, plan_index &index,
+               std::string const &index_file, unsigned long long hash,
+               bool verify_index) {
+  server_state state(graph, b, permutation, rev_permutation);
+  state.index_file = index_file;
+  state.hash = hash;
+  state.verify_index = verify_index;
+  state.indexes.push_back(index);
+  index = {};
+
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    printf("Error: socket path too long: %s\n", socket_path.c_str());
+    return 1;
+  }
+  socket_path.copy(address.sun_path, socket_path.size());
+  state.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(socket_path.c_str());
+  if (state.listener < 0 ||
+      bind(state.listener, (sockaddr *)&address, sizeof(address)) < 0 ||
+      listen(state.listener, 128) < 0) {
+    printf("Error: cannot listen on: %s\n", socket_path.c_str());
+    return 1;
+  }
+  std::cout << "Listening on " << socket_path << " with " << workers
+            << " workers." << std::endl;
+
+  std::vector<std::thread> pool;
+  for (int i = 0; i < workers; ++i)
+    pool.emplace_back(worker, std::ref(state));
+
+  int fd;
+  while (!state.stop && (fd = accept(state.listener, nullptr, nullptr)) >= 0) {
+    std::lock_guard<std::mutex> lock(state.connections_mutex);
+    state.connections.insert(fd);
+    std::thread(connection, std::ref(state), fd).detach();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stop = true;
+  }
+  state.cv.notify_all();
+  for (auto &t : pool)
+    t.join();
+
+  // Wake up the connections still waiting for a query and wait for them.
+  {
+    std::unique_lock<std::mutex> lock(state.connections_mutex);
+    for (auto const &c : state.connections)
+      ::shutdown(c, SHUT_RDWR);
+    state.connections_cv.wait(lock, [&state] {
+      return state.connections.empty();
+    });
+  }
+  close(state.listener);
+  unlink(socket_path.c_str());
+  for (auto &i : state.indexes)
+    close_index(i);
+  std::cout << stats(state).substr(3) << std::endl;
+  return 0;
+}
@@ -9,6 +9,7 @@
 #include <random>
 #include <set>
 #include <stdio.h>
+#include <string>
 #include <utility>
 #include <unordered_set>
 #include <vector>
@@ -17,6 +18,13 @@
 #define pii std::pair<int, int>
 #define tii std::tuple<int, int, int>
 
+// Compressed adjacency (defined in 'compressed.hpp').
+struct compressed_graph;
+
+// Latency budget and anytime report of a query (defined in 'deadline.hpp').
+struct query_deadline;
+struct anytime_result;
+
 // Useful functions (implemented in 'utils.cpp').
 void print_array(std::vector<int> &v);
 
@@ -38,6 +46,46 @@ void random_permutation(int n,
                         std::vector<int> &permutation,
                         std::vector<int> &rev_permutation);
 
+// Read-only adjacency in CSR form: the edges (w, v) of u are edges[offsets[u]]
+// to edges[offsets[u + 1] - 1].
+struct csr_adjacency {
+  struct range {
+    const pii *first, *last;
+    const pii *begin() const { return first; }
+    const pii *end() const { return last; }
+  };
+  const int *offsets = nullptr;
+  const pii *edges = nullptr;
+  range operator[](int u) const {
+    return {edges + offsets[u], edges + offsets[u + 1]};
+  }
+};
+
+// Derived graphs of the engines built once per graph by the 'prepare_*'
+// functions and reused by the queries (see '1-task.cpp'). The views point to
+// 'ints' and 'pairs' when the plan is built in memory, or to the arrays of an
+// index file when it's mapped from it (see 'index.cpp'). A copy would keep
+// the views on the arrays of the original, so the plans can't be copied.
+struct yen_plan {
+  yen_plan() = default;
+  yen_plan(const yen_plan &) = delete;
+  yen_plan &operator=(const yen_plan &) = delete;
+  int n = 0;
+  const int *rev_permutation = nullptr;
+  csr_adjacency ef, eb;
+  std::vector<int> ints;
+  std::vector<pii> pairs;
+};
+struct delta_plan {
+  delta_plan() = default;
+  delta_plan(const delta_plan &) = delete;
+  delta_plan &operator=(const delta_plan &) = delete;
+  int delta = 0;
+  csr_adjacency el, eh;
+  std::vector<int> ints;
+  std::vector<pii> pairs;
+};
+
 // Function headers for task 1 (implemented in '1-task.cpp'):
 void dijkstra(std::vector<std::vector<tii>> &graph,
               std::vector<int> &d,
@@ -79,6 +127,68 @@ void delta_stepping_timed(std::vector<std::vector<tii>> &graph,
                     std::vector<int> &pred,
                     int source, int target, int delta,
                     long long int &preprocess_time, long long int &computation_time);
+void attach_yen_plan(yen_plan &plan, int n, const int *ints,
+                     const pii *pairs);
+void attach_delta_plan(delta_plan &plan, int n, int delta, const int *ints,
+                       const pii *pairs);
+void prepare_yen(std::vector<std::vector<tii>> &graph, yen_plan &plan);
+void bellman_ford_yen_prepared(yen_plan &plan,
+                               std::vector<int> &d,
+                               std::vector<int> &pred,
+                               int source, int target);
+void bellman_ford_yen_prepared_timed(yen_plan &plan,
+                                     std::vector<int> &d,
+                                     std::vector<int> &pred,
+                                     int source, int target,
+                                     long long int &preprocess_time,
+                                     long long int &computation_time);
+void prepare_delta_stepping(std::vector<std::vector<tii>> &graph, int delta,
+                            delta_plan &plan);
+void delta_stepping_prepared(delta_plan &plan,
+                             std::vector<int> &d,
+                             std::vector<int> &pred,
+                             int source, int target);
+void delta_stepping_prepared_timed(delta_plan &plan,
+                                   std::vector<int> &d,
+                                   std::vector<int> &pred,
+                                   int source, int target,
+                                   long long int &preprocess_time,
+                                   long long int &computation_time);
+bool bellman_ford_tarjan(std::vector<std::vector<tii>> &graph,
+                         std::vector<int> &d,
+                         std::vector<int> &pred,
+                         int source, int target, std::vector<int> &cycle);
+bool bellman_ford_tarjan_timed(std::vector<std::vector<tii>> &graph,
+                               std::vector<int> &d,
+                               std::vector<int> &pred,
+                               int source, int target, std::vector<int> &cycle,
+                               long long int &preprocess_time, long long int &computation_time);
+bool johnson_potentials(std::vector<std::vector<tii>> &graph,
+                        std::vector<int> &h, std::vector<int> &cycle);
+void johnson_reweight(std::vector<std::vector<tii>> &graph,
+                      std::vector<int> &h,
+                      std::vector<std::vector<tii>> &reweighted);
+void dijkstra_johnson(std::vector<std::vector<tii>> &reweighted,
+                      std::vector<int> &h,
+                      std::vector<int> &d,
+                      std::vector<int> &pred,
+                      int source, int target);
+void dijkstra_johnson_timed(std::vector<std::vector<tii>> &reweighted,
+                            std::vector<int> &h,
+                            std::vector<int> &d,
+                            std::vector<int> &pred,
+                            int source, int target,
+                            long long int &preprocess_time, long long int &computation_time);
+void dijkstra_compressed(compressed_graph &cg,
+                         std::vector<int> &d,
+                         std::vector<int> &pred,
+                         int source, int target);
+void dijkstra_compressed_timed(compressed_graph &cg,
+                               std::vector<int> &d,
+                               std::vector<int> &pred,
+                               int source, int target,
+                               long long int &preprocess_time,
+                               long long int &computation_time);
 
 // Function headers for task 2 (implemented in '2-task.cpp'):
 void dijkstra_constrained(std::vector<std::vector<tii>> &graph,
@@ -90,6 +200,44 @@ void dijkstra_constrained_timed(std::vector<std::vector<tii>> &graph,
                           std::vector<std::vector<pii>> &pred,
                           int source, int target, int b,
                           long long int &preprocess_time, long long int &computation_time);
+void dijkstra_constrained_anytime(std::vector<std::vector<tii>> &graph,
+                                  std::vector<std::vector<int>> &d,
+                                  std::vector<std::vector<pii>> &pred,
+                                  int source, int target, int b,
+                                  query_deadline &deadline,
+                                  anytime_result &result);
+void dijkstra_constrained_bucket(std::vector<std::vector<tii>> &graph,
+                                 std::vector<std::vector<int>> &d,
+                                 std::vector<std::vector<pii>> &pred,
+                                 int source, int target, int b);
+void dijkstra_constrained_bucket_timed(std::vector<std::vector<tii>> &graph,
+                                       std::vector<std::vector<int>> &d,
+                                       std::vector<std::vector<pii>> &pred,
+                                       int source, int target, int b,
+                                       long long int &preprocess_time,
+                                       long long int &computation_time);
+void dijkstra_constrained_bucket_anytime(std::vector<std::vector<tii>> &graph,
+                                         std::vector<std::vector<int>> &d,
+                                         std::vector<std::vector<pii>> &pred,
+                                         int source, int target, int b,
+                                         query_deadline &deadline,
+                                         anytime_result &result);
+void dijkstra_constrained_compressed(compressed_graph &cg,
+                                     std::vector<std::vector<int>> &d,
+                                     std::vector<std::vector<pii>> &pred,
+                                     int source, int target, int b);
+void dijkstra_constrained_compressed_anytime(compressed_graph &cg,
+                                             std::vector<std::vector<int>> &d,
+                                             std::vector<std::vector<pii>> &pred,
+                                             int source, int target, int b,
+                                             query_deadline &deadline,
+                                             anytime_result &result);
+void dijkstra_constrained_compressed_timed(compressed_graph &cg,
+                                           std::vector<std::vector<int>> &d,
+                                           std::vector<std::vector<pii>> &pred,
+                                           int source, int target, int b,
+                                           long long int &preprocess_time,
+                                           long long int &computation_time);
 void bellman_ford_constrained(std::vector<std::vector<tii>> &graph,
                               std::vector<std::vector<int>> &d,
                               std::vector<std::vector<pii>> &pred,
@@ -100,7 +248,158 @@ void bellman_ford_constrained_timed(std::vector<std::vector<tii>> &graph,
                               std::vector<std::vector<pii>> &pred,
                               int source, int target, int b,
                               long long int &preprocess_time, long long int &computation_time);
+void bellman_ford_constrained_anytime(std::vector<std::vector<tii>> &graph,
+                                      std::vector<std::vector<int>> &d,
+                                      std::vector<std::vector<pii>> &pred,
+                                      int source, int target, int b,
+                                      query_deadline &deadline,
+                                      anytime_result &result);
+int dijkstra_constrained_bidirectional(std::vector<std::vector<tii>> &graph,
+                                       std::vector<int> &path, int &delay,
+                                       int source, int target, int b,
+                                       long long int &memory);
+int dijkstra_constrained_bidirectional_timed(
+    std::vector<std::vector<tii>> &graph, std::vector<int> &path, int &delay,
+    int source, int target, int b, long long int &memory,
+    long long int &preprocess_time, long long int &computation_time);
+int bellman_ford_constrained_checkpointed(std::vector<std::vector<tii>> &graph,
+                                          std::vector<int> &path, int &delay,
+                                          int source, int target, int b,
+                                          int interval, long long int &memory);
+int bellman_ford_constrained_checkpointed_timed(
+    std::vector<std::vector<tii>> &graph, std::vector<int> &path, int &delay,
+    int source, int target, int b, int interval, long long int &memory,
+    long long int &preprocess_time, long long int &computation_time);
 
 // Function headers for task 3 (implemented in '3-task.cpp'):
 std::vector<std::vector<int>> dijkstra_k_shortest_paths(std::vector<std::vector<tii>> &graph,
                                                         int source, int k);
+std::vector<std::vector<int>>
+dijkstra_k_shortest_paths_anytime(std::vector<std::vector<tii>> &graph,
+                                  int source, int k, query_deadline &deadline,
+                                  anytime_result &result);
+
+// Function headers for the vertex reordering (implemented in 'reorder.cpp'):
+bool reorder_permutation(std::vector<std::vector<tii>> &graph,
+                         std::string const &method,
+                         std::vector<int> &permutation,
+                         std::vector<int> &rev_permutation);
+void reorder_graph(std::vector<std::vector<tii>> &graph,
+                   std::vector<int> &permutation);
+double average_edge_span(std::vector<std::vector<tii>> &graph, int &bandwidth);
+
+int cache_misses_start();
+long long int cache_misses_stop(int fd);
+
+// Function headers for the graph profile and the automatic engine selection
+// (implemented in 'profile.cpp'):
+struct graph_profile {
+  int n, m;
+  int min_weight, max_weight;
+  double average_weight;
+  long long int negative_edges, zero_delay_edges;
+  double average_degree;
+  int degree_p99, max_degree;
+  int diameter;
+};
+
+void profile_graph(std::vector<std::vector<tii>> &graph,
+                   graph_profile &profile);
+int auto_select_engine(std::vector<std::vector<tii>> &graph,
+                       graph_profile &profile, int source, int &delta,
+                       std::string &log);
+
+// Function headers for the compressed adjacency (implemented in
+// 'compressed.cpp'):
+bool compress_graph(std::vector<std::vector<tii>> &graph, compressed_graph &cg,
+                    bool release);
+long long int compressed_graph_memory(compressed_graph &cg);
+long long int graph_memory(std::vector<std::vector<tii>> &graph);
+
+// Function headers for the index store (implemented in 'index.cpp'):
+// An index file mapped in memory and its sections (the arrays of a plan, the
+// Δ of the Δ-stepping plans being the parameter).
+struct index_section {
+  int type, param;
+  size_t offset, ints, pairs;
+  unsigned long long checksum;
+};
+struct plan_index {
+  const char *data = nullptr;
+  size_t size = 0;
+  std::vector<index_section> sections;
+};
+
+unsigned long long graph_hash(std::vector<std::vector<tii>> &graph);
+bool open_index(plan_index &index, std::string const &file_name,
+                unsigned long long hash, int n);
+void close_index(plan_index &index);
+bool index_yen_plan(plan_index &index, int n, yen_plan &plan, bool verify);
+bool index_delta_plan(plan_index &index, int n, int delta, delta_plan &plan,
+                      bool verify);
+bool save_index(plan_index &index, std::string const &file_name,
+                unsigned long long hash, int n, yen_plan *yen,
+                delta_plan *delta);
+
+// Function headers for the query server (implemented in 'server.cpp'):
+int run_server(std::vector<std::vector<tii>> &graph, int b,
+               std::string const &socket_path, int workers,
+               std::vector<int> &permutation,
+               std::vector<int> &rev_permutation, plan_index &index,
+               std::string const &index_file, unsigned long long hash,
+               bool verify_index);
+
+// Function headers for the hub labeling (implemented in 'hub_labels.cpp'):
+// A label entry: the hub (its rank in 'order'), the distance to (or from) it
+// and the parent i.e. the next vertex toward the hub (for the path retrieval).
+struct hub_label {
+  int hub, dist, parent;
+};
+struct hub_labels {
+  std::vector<int> order;
+  std::vector<std::vector<hub_label>> in, out;
+};
+
+bool build_hub_labels(std::vector<std::vector<tii>> &graph, hub_labels &hl);
+void hub_labels_query(hub_labels &hl,
+                      std::vector<int> &d,
+                      std::vector<int> &pred,
+                      int source, int target);
+void hub_labels_query_timed(hub_labels &hl,
+                            std::vector<int> &d,
+                            std::vector<int> &pred,
+                            int source, int target,
+                            long long int &preprocess_time, long long int &computation_time);
+long long int hub_labels_size(hub_labels &hl, long long int &memory);
+bool save_hub_labels(hub_labels &hl, std::string const &file_name,
+                     unsigned long long hash);
+bool load_hub_labels(hub_labels &hl, std::string const &file_name, int n,
+                     unsigned long long hash);
+
+// Function headers for the customizable route planning (implemented in
+// 'crp.cpp'):
+// For each level l (0 for the finest cells): the cell of each vertex, the
+// boundary vertices of each cell (and the index of each vertex in it, -1 if
+// it's not a boundary vertex) and the clique of each cell (row-major matrix of
+// the distances between its boundary vertices).
+struct crp_overlay {
+  int levels;
+  std::vector<int> cells;
+  std::vector<std::vector<int>> cell, index;
+  std::vector<std::vector<std::vector<int>>> boundary, clique;
+  std::vector<std::vector<tii>> reverse;
+};
+
+void crp_partition(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                   int cell_size, int levels);
+bool crp_customize(std::vector<std::vector<tii>> &graph, crp_overlay &ov);
+void crp_query(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+               std::vector<int> &d,
+               std::vector<int> &pred,
+               int source, int target);
+void crp_query_timed(std::vector<std::vector<tii>> &graph, crp_overlay &ov,
+                     std::vector<int> &d,
+                     std::vector<int> &pred,
+                     int source, int target,
+                     long long int &preprocess_time, long long int &computation_time);
+long long int crp_overlay_memory(crp_overlay &ov, long long int &boundary);
@@ -0,0 +1,130 @@
+import os
+import random
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+# Regression test of the query server ('./main [graph] --serve=...'): the
+# queries to a vertex which is unreachable, alone or coalesced with queries
+# from the same source, are answered by 'ERROR unreachable target' and the
+# other ones by the same length as Dijkstra (and, for the task 2, the same
+# length and delay as the constrained Dijkstra).
+
+NUM_VERTICES = 2000
+NUM_EDGES = 10000
+NUM_CLIENTS = 8
+MAIN = sys.argv[1] if len(sys.argv) > 1 else './main'
+
+
+def write_graph(file_name: str):
+    # The vertex NUM_VERTICES has no incoming edge.
+    random.seed(1)
+    edges = [(u, u % (NUM_VERTICES - 1) + 1) for u in range(1, NUM_VERTICES)]
+    while len(edges) < NUM_EDGES:
+        edges.append((random.randint(1, NUM_VERTICES),
+                      random.randint(1, NUM_VERTICES - 1)))
+    with open(file_name, 'w') as f:
+        f.write('{} {} 10\n'.format(NUM_VERTICES, len(edges)))
+        for u, v in edges:
+            f.write('{} {} {} {}\n'.format(u, v, random.randint(1, 100),
+                                           random.randint(0, 3)))
+
+
+class Client:
+
+    def __init__(self, path: str):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        for _ in range(100):
+            try:
+                self.sock.connect(path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                time.sleep(0.1)
+        self.file = self.sock.makefile('r')
+
+    def query(self, line: str) -> str:
+        self.sock.sendall((line + '\n').encode())
+        return self.file.readline().strip()
+
+    def close(self):
+        self.sock.close()
+
+
+def main():
+    directory = tempfile.mkdtemp()
+    graph, path = directory + '/graph.txt', directory + '/server.sock'
+    write_graph(graph)
+    server = subprocess.Popen(
+        [MAIN, graph, '--serve=' + path, '--workers=1'],
+        stdout=subprocess.DEVNULL)
+    failures = []
+    try:
+        client = Client(path)
+        targets = [2, 17, 500, NUM_VERTICES]
+        expected = {t: client.query('1 1 1 {}'.format(t)) for t in targets}
+        assert expected[NUM_VERTICES] == 'ERROR unreachable target', \
+            expected[NUM_VERTICES]
+        assert all(expected[t].startswith('OK') for t in targets[:-1])
+
+        for algo in ['2', '3', '4', '5 20', '6', '7', '8', '9', '10']:
+            a, extra = (algo.split() + [''])[:2]
+            # One query alone, then a burst from several clients which keeps
+            # the single worker busy so that the queries are coalesced.
+            for t in targets:
+                r = client.query('1 {} 1 {} {}'.format(a, t, extra).strip())
+                if r.split()[:2] != expected[t].split()[:2]:
+                    failures.append((algo, t, r, expected[t]))
+            results = {}
+
+            def burst(i: int):
+                c = Client(path)
+                t = targets[i % len(targets)]
+                results[i] = (t, c.query(
+                    '1 {} 1 {} {}'.format(a, t, extra).strip()))
+                c.close()
+
+            threads = [threading.Thread(target=burst, args=(i, ))
+                       for i in range(NUM_CLIENTS)]
+            client.sock.sendall(b'1 3 1 2\n')
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+            client.file.readline()
+            for t, r in results.values():
+                if r.split()[:2] != expected[t].split()[:2]:
+                    failures.append((algo, t, r, expected[t]))
+
+        # More Δ values than the plans kept by the server.
+        for delta in range(1, 10):
+            r = client.query('1 5 1 500 {}'.format(delta))
+            if r.split()[:2] != expected[500].split()[:2]:
+                failures.append(('5 {}'.format(delta), 500, r, expected[500]))
+
+        for t in targets:
+            reference = client.query('2 1 1 {}'.format(t))
+            for algo in range(2, 7):
+                r = client.query('2 {} 1 {}'.format(algo, t))
+                if r.split()[:3] != reference.split()[:3]:
+                    failures.append(('task 2 ' + str(algo), t, r, reference))
+
+        stats = client.query('stats')
+        print(stats)
+        client.query('shutdown')
+        server.wait(timeout=30)
+    finally:
+        if server.poll() is None:
+            server.kill()
+    if server.returncode != 0:
+        failures.append(('exit code', server.returncode))
+    for f in failures:
+        print('FAILED:', *f)
+    print('OK' if not failures else '{} failures'.format(len(failures)))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()